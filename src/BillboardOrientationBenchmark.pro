@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Microbenchmark of the billboard orientation kernel
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+
+TARGET = BillboardOrientationBenchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+# build the AVX path of the kernel on machines supporting it
+#QMAKE_CXXFLAGS += -mavx
+
+SOURCES += billboardorientationbenchmark.cpp \
+    billboardorientation.cpp
+
+HEADERS  += billboardorientation.h
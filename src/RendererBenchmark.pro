@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Headless benchmark of the renderer, drawing into the offscreen framebuffer
+# of the widget. Run with -platform offscreen (or under xvfb-run),
+# LIBGL_ALWAYS_SOFTWARE=1 selects Mesa llvmpipe on machines without GPU.
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT += opengl
+QT += concurrent
+QT += widgets
+
+TARGET = RendererBenchmark
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += rendererbenchmark.cpp
+
+include(renderer.pri)
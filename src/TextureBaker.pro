@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Offline conversion of the textures into the compressed texture cache
+#
+#-------------------------------------------------
+
+QT       += core gui
+QT       -= widgets
+QT       += concurrent
+
+TARGET = TextureBaker
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+SOURCES += texturebaker.cpp \
+    texturecache.cpp \
+    textureloader.cpp
+
+HEADERS  += texturecache.h \
+    textureloader.h
+
+RESOURCES += \
+    textures.qrc
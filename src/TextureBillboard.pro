@@ -6,6 +6,7 @@
 
 QT       += core gui
 QT += opengl
+QT += concurrent
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = TextureBillboard
@@ -14,14 +15,8 @@ TEMPLATE = app
 #QMAKE_CXXFLAGS_WARN_ON += -Wno-reorder
 
 SOURCES += main.cpp\
-        mainwindow.cpp \
-    unitplane.cpp \
-    renderer.cpp
+        mainwindow.cpp
 
-HEADERS  += mainwindow.h \
-    unitplane.h \
-    renderer.h
+HEADERS  += mainwindow.h
 
-RESOURCES += \
-    shaders.qrc \
-    textures.qrc
+include(renderer.pri)
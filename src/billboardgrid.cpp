@@ -0,0 +1,213 @@
+//------------------------------------------------------------------------------------------
+// billboardgrid.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+
+#include "billboardgrid.h"
+
+//------------------------------------------------------------------------------------------
+BillboardGrid::BillboardGrid()
+{
+}
+
+//------------------------------------------------------------------------------------------
+// a billboard rotates around its center, its quad has half size equal to its scale,
+// the sway moves its corners further away
+//------------------------------------------------------------------------------------------
+float BillboardGrid::getBoundingRadius(const BillboardInstance& _instance, float _swayExtent)
+{
+    return _instance.scale * ((float)M_SQRT2 + _swayExtent);
+}
+
+//------------------------------------------------------------------------------------------
+void BillboardGrid::clear()
+{
+    cells.clear();
+    cellInstances.clear();
+}
+
+//------------------------------------------------------------------------------------------
+// counting sort of the billboards by cell index
+//------------------------------------------------------------------------------------------
+void BillboardGrid::build(const QVector<BillboardInstance>& _instances, float _cellSize)
+{
+    clear();
+
+    if(_instances.isEmpty())
+    {
+        return;
+    }
+
+    float minX = _instances[0].position.x();
+    float maxX = minX;
+    float minZ = _instances[0].position.z();
+    float maxZ = minZ;
+
+    for(int i = 1; i < _instances.size(); ++i)
+    {
+        minX = qMin(minX, _instances[i].position.x());
+        maxX = qMax(maxX, _instances[i].position.x());
+        minZ = qMin(minZ, _instances[i].position.z());
+        maxZ = qMax(maxZ, _instances[i].position.z());
+    }
+
+    int numCellsX = qMax(1, (int)ceil((maxX - minX) / _cellSize) + 1);
+    int numCellsZ = qMax(1, (int)ceil((maxZ - minZ) / _cellSize) + 1);
+
+    /////////////////////////////////////////////////////////////////
+    // count the billboards of each cell
+    QVector<int> instanceCell(_instances.size());
+    QVector<int> cellCounts(numCellsX * numCellsZ, 0);
+
+    for(int i = 0; i < _instances.size(); ++i)
+    {
+        int cx = qBound(0, (int)((_instances[i].position.x() - minX) / _cellSize), numCellsX - 1);
+        int cz = qBound(0, (int)((_instances[i].position.z() - minZ) / _cellSize), numCellsZ - 1);
+        instanceCell[i] = cz * numCellsX + cx;
+        ++cellCounts[instanceCell[i]];
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // allocate the non-empty cells and their ranges
+    QVector<int> cellMap(cellCounts.size(), -1);
+    int offset = 0;
+
+    for(int c = 0; c < cellCounts.size(); ++c)
+    {
+        if(cellCounts[c] == 0)
+        {
+            continue;
+        }
+
+        Cell cell;
+        cell.boundMin = QVector3D(1e30f, 1e30f, 1e30f);
+        cell.boundMax = QVector3D(-1e30f, -1e30f, -1e30f);
+        cell.maxScale = 0.0f;
+        cell.firstInstance = offset;
+        cell.numInstances = 0;
+
+        cellMap[c] = cells.size();
+        cells.append(cell);
+        offset += cellCounts[c];
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // scatter the billboards and grow the cell bounds,
+    // the sway is added to the bounds when culling
+    cellInstances.resize(_instances.size());
+
+    for(int i = 0; i < _instances.size(); ++i)
+    {
+        const BillboardInstance& instance = _instances[i];
+        Cell& cell = cells[cellMap[instanceCell[i]]];
+        float radius = getBoundingRadius(instance, 0.0f);
+        QVector3D extent(radius, radius, radius);
+
+        cellInstances[cell.firstInstance + cell.numInstances] = instance;
+        ++cell.numInstances;
+        cell.maxScale = qMax(cell.maxScale, instance.scale);
+
+        QVector3D instanceMin = instance.position - extent;
+        QVector3D instanceMax = instance.position + extent;
+        cell.boundMin = QVector3D(qMin(cell.boundMin.x(), instanceMin.x()),
+                                  qMin(cell.boundMin.y(), instanceMin.y()),
+                                  qMin(cell.boundMin.z(), instanceMin.z()));
+        cell.boundMax = QVector3D(qMax(cell.boundMax.x(), instanceMax.x()),
+                                  qMax(cell.boundMax.y(), instanceMax.y()),
+                                  qMax(cell.boundMax.z(), instanceMax.z()));
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// write the billboards inside the frustum and within the draw distance
+// into _visibleInstances and return their number
+//------------------------------------------------------------------------------------------
+int BillboardGrid::cull(const Frustum& _frustum, const QVector3D& _cameraPosition,
+                        float _drawDistance, float _swayExtent,
+                        QVector<BillboardInstance>& _visibleInstances) const
+{
+    if(_visibleInstances.size() < cellInstances.size())
+    {
+        _visibleInstances.resize(cellInstances.size());
+    }
+
+    BillboardInstance* output = _visibleInstances.data();
+    int numVisible = 0;
+    float drawDistance2 = _drawDistance * _drawDistance;
+
+    for(int c = 0; c < cells.size(); ++c)
+    {
+        const Cell& cell = cells[c];
+        float sway = cell.maxScale * _swayExtent;
+        QVector3D boundMin = cell.boundMin - QVector3D(sway, sway, sway);
+        QVector3D boundMax = cell.boundMax + QVector3D(sway, sway, sway);
+        Frustum::Intersection intersection = _frustum.classifyBox(boundMin, boundMax);
+
+        if(intersection == Frustum::OUTSIDE)
+        {
+            continue;
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // nearest and farthest distances from the camera to the cell bounds
+        float nearest2 = 0.0f;
+        float farthest2 = 0.0f;
+
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            float toMin = boundMin[axis] - _cameraPosition[axis];
+            float toMax = _cameraPosition[axis] - boundMax[axis];
+            float nearest = qMax(0.0f, qMax(toMin, toMax));
+            float farthest = qMax(fabsf(toMin), fabsf(toMax));
+
+            nearest2 += nearest * nearest;
+            farthest2 += farthest * farthest;
+        }
+
+        if(nearest2 > drawDistance2)
+        {
+            continue;
+        }
+
+        const BillboardInstance* instances = &cellInstances[cell.firstInstance];
+
+        if(intersection == Frustum::INSIDE && farthest2 <= drawDistance2)
+        {
+            std::copy(instances, instances + cell.numInstances, output + numVisible);
+            numVisible += cell.numInstances;
+            continue;
+        }
+
+        for(int i = 0; i < cell.numInstances; ++i)
+        {
+            float radius = getBoundingRadius(instances[i], _swayExtent);
+            float distance = (instances[i].position - _cameraPosition).length() - radius;
+
+            if(distance <= _drawDistance &&
+               _frustum.containsSphere(instances[i].position, radius))
+            {
+                output[numVisible++] = instances[i];
+            }
+        }
+    }
+
+    return numVisible;
+}
+
+//------------------------------------------------------------------------------------------
+int BillboardGrid::getNumCells() const
+{
+    return cells.size();
+}
+
+//------------------------------------------------------------------------------------------
+int BillboardGrid::getNumInstances() const
+{
+    return cellInstances.size();
+}
@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------------------
+// billboardgrid.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef BILLBOARDGRID_H
+#define BILLBOARDGRID_H
+
+#include <QVector>
+
+#include "billboardinstance.h"
+#include "frustum.h"
+
+//------------------------------------------------------------------------------------------
+// uniform grid over the ground plane (xz), each cell keeps the bounds of its billboards
+// and the billboards are stored contiguously per cell,
+// so cells completely inside the frustum are copied without per-instance tests
+//------------------------------------------------------------------------------------------
+class BillboardGrid
+{
+public:
+    BillboardGrid();
+
+    void build(const QVector<BillboardInstance>& _instances, float _cellSize);
+    void clear();
+
+    // _swayExtent is the farthest the billboard corners are displaced by the vertex shader,
+    // relative to the billboard scale
+    int cull(const Frustum& _frustum, const QVector3D& _cameraPosition, float _drawDistance,
+             float _swayExtent, QVector<BillboardInstance>& _visibleInstances) const;
+
+    int getNumCells() const;
+    int getNumInstances() const;
+
+    static float getBoundingRadius(const BillboardInstance& _instance, float _swayExtent);
+
+private:
+    struct Cell
+    {
+        QVector3D boundMin;
+        QVector3D boundMax;
+        float maxScale;
+        int firstInstance;
+        int numInstances;
+    };
+
+    QVector<Cell> cells;
+    QVector<BillboardInstance> cellInstances;
+};
+
+#endif // BILLBOARDGRID_H
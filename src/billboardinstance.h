@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------------
+// billboardinstance.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef BILLBOARDINSTANCE_H
+#define BILLBOARDINSTANCE_H
+
+#include <qopengl.h>
+#include <QVector3D>
+#include <QVector4D>
+
+//------------------------------------------------------------------------------------------
+// per-instance data of a billboard, tightly packed to be used as vertex attributes
+//------------------------------------------------------------------------------------------
+struct BillboardInstance
+{
+    BillboardInstance():
+        position(0.0f, 0.0f, 0.0f),
+        scale(1.0f),
+        tint(1.0f, 1.0f, 1.0f, 1.0f),
+        textureLayer(0.0f) {}
+
+    static int getStructSize()
+    {
+        return (3 + 1 + 4 + 1) * sizeof(GLfloat);
+    }
+
+    static int getScaleOffset()
+    {
+        return 3 * sizeof(GLfloat);
+    }
+
+    static int getTintOffset()
+    {
+        return 4 * sizeof(GLfloat);
+    }
+
+    static int getTextureLayerOffset()
+    {
+        return 8 * sizeof(GLfloat);
+    }
+
+    QVector3D position;
+    GLfloat scale;
+    QVector4D tint;
+    GLfloat textureLayer;
+};
+
+#endif // BILLBOARDINSTANCE_H
@@ -0,0 +1,308 @@
+//------------------------------------------------------------------------------------------
+// billboardorientation.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "billboardorientation.h"
+
+//------------------------------------------------------------------------------------------
+// minimax polynomial of atan(t) for t in [0, 1], max error ~1e-5 rad
+//------------------------------------------------------------------------------------------
+#define ATAN_C0  0.99986600f
+#define ATAN_C1 -0.33029950f
+#define ATAN_C2  0.18014100f
+#define ATAN_C3 -0.08513300f
+#define ATAN_C4  0.02083510f
+#define ORIENTATION_EPSILON 1e-12f
+
+//------------------------------------------------------------------------------------------
+float BillboardOrientation::fastAtan2(float _y, float _x)
+{
+    float ax = fabsf(_x);
+    float ay = fabsf(_y);
+    float mx = ax > ay ? ax : ay;
+    float mn = ax > ay ? ay : ax;
+    float t = (mx > ORIENTATION_EPSILON) ? mn / mx : 0.0f;
+    float t2 = t * t;
+
+    float r = t * (ATAN_C0 + t2 * (ATAN_C1 + t2 * (ATAN_C2 + t2 * (ATAN_C3 + t2 * ATAN_C4))));
+
+    if(ay > ax)
+    {
+        r = (float)M_PI_2 - r;
+    }
+
+    if(_x < 0.0f)
+    {
+        r = (float)M_PI - r;
+    }
+
+    return (_y < 0.0f) ? -r : r;
+}
+
+//------------------------------------------------------------------------------------------
+void BillboardOrientation::computeScalar(const BillboardPositionSoA& _positions,
+                                         const QVector3D& _cameraPosition,
+                                         int _begin, int _end,
+                                         float* _yawAngles,
+                                         float* _modelMatrices)
+{
+    for(int i = _begin; i < _end; ++i)
+    {
+        float dx = _cameraPosition.x() - _positions.x[i];
+        float dz = _cameraPosition.z() - _positions.z[i];
+
+        _yawAngles[i] = fastAtan2(dx, dz);
+
+        if(!_modelMatrices)
+        {
+            continue;
+        }
+
+        float len2 = dx * dx + dz * dz;
+        float c = 1.0f;
+        float s = 0.0f;
+
+        if(len2 > ORIENTATION_EPSILON)
+        {
+            float invLen = 1.0f / sqrtf(len2);
+            c = dz * invLen;
+            s = dx * invLen;
+        }
+
+        float scale = _positions.scale[i];
+        float* m = &_modelMatrices[12 * i];
+
+        m[0] = c * scale;
+        m[1] = s * scale;
+        m[2] = 0.0f;
+        m[3] = _positions.x[i];
+
+        m[4] = 0.0f;
+        m[5] = 0.0f;
+        m[6] = -scale;
+        m[7] = _positions.y[i];
+
+        m[8] = -s * scale;
+        m[9] = c * scale;
+        m[10] = 0.0f;
+        m[11] = _positions.z[i];
+    }
+}
+
+#if defined(__SSE2__) || defined(__AVX__)
+//------------------------------------------------------------------------------------------
+// write the 3x4 matrices of 4 billboards, the SoA lanes are transposed into matrix rows
+//------------------------------------------------------------------------------------------
+static inline void storeMatrices4(float* _out, __m128 _c, __m128 _s, __m128 _scale,
+                                  __m128 _px, __m128 _py, __m128 _pz)
+{
+    __m128 zero = _mm_setzero_ps();
+
+    __m128 r0a = _mm_mul_ps(_c, _scale);
+    __m128 r0b = _mm_mul_ps(_s, _scale);
+    __m128 r0c = zero;
+    __m128 r0d = _px;
+    _MM_TRANSPOSE4_PS(r0a, r0b, r0c, r0d);
+
+    __m128 r1a = zero;
+    __m128 r1b = zero;
+    __m128 r1c = _mm_sub_ps(zero, _scale);
+    __m128 r1d = _py;
+    _MM_TRANSPOSE4_PS(r1a, r1b, r1c, r1d);
+
+    __m128 r2a = _mm_sub_ps(zero, _mm_mul_ps(_s, _scale));
+    __m128 r2b = _mm_mul_ps(_c, _scale);
+    __m128 r2c = zero;
+    __m128 r2d = _pz;
+    _MM_TRANSPOSE4_PS(r2a, r2b, r2c, r2d);
+
+    _mm_storeu_ps(_out + 0, r0a);
+    _mm_storeu_ps(_out + 4, r1a);
+    _mm_storeu_ps(_out + 8, r2a);
+
+    _mm_storeu_ps(_out + 12, r0b);
+    _mm_storeu_ps(_out + 16, r1b);
+    _mm_storeu_ps(_out + 20, r2b);
+
+    _mm_storeu_ps(_out + 24, r0c);
+    _mm_storeu_ps(_out + 28, r1c);
+    _mm_storeu_ps(_out + 32, r2c);
+
+    _mm_storeu_ps(_out + 36, r0d);
+    _mm_storeu_ps(_out + 40, r1d);
+    _mm_storeu_ps(_out + 44, r2d);
+}
+#endif
+
+#if defined(__AVX__)
+//------------------------------------------------------------------------------------------
+static inline __m256 atan2AVX(__m256 _y, __m256 _x)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 ax = _mm256_andnot_ps(signMask, _x);
+    __m256 ay = _mm256_andnot_ps(signMask, _y);
+    __m256 mx = _mm256_max_ps(ax, ay);
+    __m256 mn = _mm256_min_ps(ax, ay);
+    __m256 t = _mm256_div_ps(mn, _mm256_max_ps(mx, _mm256_set1_ps(ORIENTATION_EPSILON)));
+    __m256 t2 = _mm256_mul_ps(t, t);
+
+    __m256 r = _mm256_set1_ps(ATAN_C4);
+    r = _mm256_add_ps(_mm256_mul_ps(r, t2), _mm256_set1_ps(ATAN_C3));
+    r = _mm256_add_ps(_mm256_mul_ps(r, t2), _mm256_set1_ps(ATAN_C2));
+    r = _mm256_add_ps(_mm256_mul_ps(r, t2), _mm256_set1_ps(ATAN_C1));
+    r = _mm256_add_ps(_mm256_mul_ps(r, t2), _mm256_set1_ps(ATAN_C0));
+    r = _mm256_mul_ps(r, t);
+
+    __m256 swapMask = _mm256_cmp_ps(ay, ax, _CMP_GT_OQ);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps((float)M_PI_2), r), swapMask);
+
+    __m256 negXMask = _mm256_cmp_ps(_x, _mm256_setzero_ps(), _CMP_LT_OQ);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps((float)M_PI), r), negXMask);
+
+    // copy the sign of y
+    return _mm256_or_ps(r, _mm256_and_ps(_y, signMask));
+}
+
+#elif defined(__SSE2__)
+//------------------------------------------------------------------------------------------
+static inline __m128 select4(__m128 _a, __m128 _b, __m128 _mask)
+{
+    return _mm_or_ps(_mm_andnot_ps(_mask, _a), _mm_and_ps(_mask, _b));
+}
+
+//------------------------------------------------------------------------------------------
+static inline __m128 atan2SSE(__m128 _y, __m128 _x)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 ax = _mm_andnot_ps(signMask, _x);
+    __m128 ay = _mm_andnot_ps(signMask, _y);
+    __m128 mx = _mm_max_ps(ax, ay);
+    __m128 mn = _mm_min_ps(ax, ay);
+    __m128 t = _mm_div_ps(mn, _mm_max_ps(mx, _mm_set1_ps(ORIENTATION_EPSILON)));
+    __m128 t2 = _mm_mul_ps(t, t);
+
+    __m128 r = _mm_set1_ps(ATAN_C4);
+    r = _mm_add_ps(_mm_mul_ps(r, t2), _mm_set1_ps(ATAN_C3));
+    r = _mm_add_ps(_mm_mul_ps(r, t2), _mm_set1_ps(ATAN_C2));
+    r = _mm_add_ps(_mm_mul_ps(r, t2), _mm_set1_ps(ATAN_C1));
+    r = _mm_add_ps(_mm_mul_ps(r, t2), _mm_set1_ps(ATAN_C0));
+    r = _mm_mul_ps(r, t);
+
+    r = select4(r, _mm_sub_ps(_mm_set1_ps((float)M_PI_2), r), _mm_cmpgt_ps(ay, ax));
+    r = select4(r, _mm_sub_ps(_mm_set1_ps((float)M_PI), r),
+                _mm_cmplt_ps(_x, _mm_setzero_ps()));
+
+    // copy the sign of y
+    return _mm_or_ps(r, _mm_and_ps(_y, signMask));
+}
+#endif
+
+//------------------------------------------------------------------------------------------
+void BillboardOrientation::computeYawAngles(const BillboardPositionSoA& _positions,
+                                            const QVector3D& _cameraPosition,
+                                            float* _yawAngles)
+{
+    computeModelMatrices(_positions, _cameraPosition, _yawAngles, NULL);
+}
+
+//------------------------------------------------------------------------------------------
+void BillboardOrientation::computeModelMatrices(const BillboardPositionSoA& _positions,
+                                                const QVector3D& _cameraPosition,
+                                                float* _yawAngles,
+                                                float* _modelMatrices)
+{
+    const int numBillboards = _positions.size();
+    const float* px = _positions.x.constData();
+    const float* py = _positions.y.constData();
+    const float* pz = _positions.z.constData();
+    const float* ps = _positions.scale.constData();
+    int i = 0;
+
+#if defined(__AVX__)
+    const __m256 camX = _mm256_set1_ps(_cameraPosition.x());
+    const __m256 camZ = _mm256_set1_ps(_cameraPosition.z());
+    const __m256 epsilon = _mm256_set1_ps(ORIENTATION_EPSILON);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    for(; i + 8 <= numBillboards; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(px + i);
+        __m256 z = _mm256_loadu_ps(pz + i);
+        __m256 dx = _mm256_sub_ps(camX, x);
+        __m256 dz = _mm256_sub_ps(camZ, z);
+
+        _mm256_storeu_ps(_yawAngles + i, atan2AVX(dx, dz));
+
+        if(!_modelMatrices)
+        {
+            continue;
+        }
+
+        __m256 len2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        __m256 valid = _mm256_cmp_ps(len2, epsilon, _CMP_GT_OQ);
+        __m256 invLen = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_max_ps(len2, epsilon)));
+        __m256 c = _mm256_blendv_ps(one, _mm256_mul_ps(dz, invLen), valid);
+        __m256 s = _mm256_and_ps(_mm256_mul_ps(dx, invLen), valid);
+        __m256 y = _mm256_loadu_ps(py + i);
+        __m256 scale = _mm256_loadu_ps(ps + i);
+
+        storeMatrices4(_modelMatrices + 12 * i,
+                       _mm256_castps256_ps128(c), _mm256_castps256_ps128(s),
+                       _mm256_castps256_ps128(scale), _mm256_castps256_ps128(x),
+                       _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+        storeMatrices4(_modelMatrices + 12 * (i + 4),
+                       _mm256_extractf128_ps(c, 1), _mm256_extractf128_ps(s, 1),
+                       _mm256_extractf128_ps(scale, 1), _mm256_extractf128_ps(x, 1),
+                       _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+    }
+
+#elif defined(__SSE2__)
+    const __m128 camX = _mm_set1_ps(_cameraPosition.x());
+    const __m128 camZ = _mm_set1_ps(_cameraPosition.z());
+    const __m128 epsilon = _mm_set1_ps(ORIENTATION_EPSILON);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for(; i + 4 <= numBillboards; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(px + i);
+        __m128 z = _mm_loadu_ps(pz + i);
+        __m128 dx = _mm_sub_ps(camX, x);
+        __m128 dz = _mm_sub_ps(camZ, z);
+
+        _mm_storeu_ps(_yawAngles + i, atan2SSE(dx, dz));
+
+        if(!_modelMatrices)
+        {
+            continue;
+        }
+
+        __m128 len2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        __m128 valid = _mm_cmpgt_ps(len2, epsilon);
+        __m128 invLen = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(len2, epsilon)));
+        __m128 c = select4(one, _mm_mul_ps(dz, invLen), valid);
+        __m128 s = _mm_and_ps(_mm_mul_ps(dx, invLen), valid);
+
+        storeMatrices4(_modelMatrices + 12 * i, c, s, _mm_loadu_ps(ps + i),
+                       x, _mm_loadu_ps(py + i), z);
+    }
+#else
+    Q_UNUSED(px);
+    Q_UNUSED(py);
+    Q_UNUSED(pz);
+    Q_UNUSED(ps);
+#endif
+
+    computeScalar(_positions, _cameraPosition, i, numBillboards, _yawAngles, _modelMatrices);
+}
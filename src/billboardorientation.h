@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------------------
+// billboardorientation.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef BILLBOARDORIENTATION_H
+#define BILLBOARDORIENTATION_H
+
+#include <QVector>
+#include <QVector3D>
+
+//------------------------------------------------------------------------------------------
+// structure-of-arrays billboard positions, used by the batched orientation kernel
+//------------------------------------------------------------------------------------------
+struct BillboardPositionSoA
+{
+    void resize(int _size)
+    {
+        x.resize(_size);
+        y.resize(_size);
+        z.resize(_size);
+        scale.resize(_size);
+    }
+
+    int size() const
+    {
+        return x.size();
+    }
+
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<float> scale;
+};
+
+//------------------------------------------------------------------------------------------
+// CPU-side cylindrical billboard orientation, for picking, physics and export.
+// The yaw angle of each billboard turns its unit plane toward the camera,
+// the model matrix is stored as 3 rows x 4 columns (row-major) per billboard:
+// rotation and scale in the first 3 columns, position in the last one.
+// The kernel uses AVX when compiled with it, SSE2 otherwise, scalar on other targets.
+//------------------------------------------------------------------------------------------
+class BillboardOrientation
+{
+public:
+    static void computeYawAngles(const BillboardPositionSoA& _positions,
+                                 const QVector3D& _cameraPosition,
+                                 float* _yawAngles);
+
+    static void computeModelMatrices(const BillboardPositionSoA& _positions,
+                                     const QVector3D& _cameraPosition,
+                                     float* _yawAngles,
+                                     float* _modelMatrices);
+
+    static float fastAtan2(float _y, float _x);
+
+private:
+    static void computeScalar(const BillboardPositionSoA& _positions,
+                              const QVector3D& _cameraPosition,
+                              int _begin, int _end,
+                              float* _yawAngles,
+                              float* _modelMatrices);
+};
+
+#endif // BILLBOARDORIENTATION_H
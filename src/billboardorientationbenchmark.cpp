@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------------------
+// billboardorientationbenchmark.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+// Compare the batched billboard orientation kernel against the per-object
+// atan2 + QMatrix4x4::rotate path, at 1k, 100k and 1M billboards
+//------------------------------------------------------------------------------------------
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMatrix4x4>
+#include <QTextStream>
+
+#include <cmath>
+
+#include "billboardorientation.h"
+
+#define NUM_REPEATS 10
+
+//------------------------------------------------------------------------------------------
+void generatePositions(BillboardPositionSoA& _positions, int _numBillboards)
+{
+    _positions.resize(_numBillboards);
+    srand(0);
+
+    for(int i = 0; i < _numBillboards; ++i)
+    {
+        _positions.x[i] = ((float)rand() / (float)RAND_MAX - 0.5f) * 1000.0f;
+        _positions.z[i] = ((float)rand() / (float)RAND_MAX - 0.5f) * 1000.0f;
+        _positions.scale[i] = 2.0f + 2.0f * (float)rand() / (float)RAND_MAX;
+        _positions.y[i] = _positions.scale[i];
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// the orientation path used before the kernel, one QMatrix4x4 per billboard
+//------------------------------------------------------------------------------------------
+double benchmarkQMatrix4x4(const BillboardPositionSoA& _positions,
+                          const QVector3D& _cameraPosition,
+                          QVector<QMatrix4x4>& _modelMatrices)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for(int i = 0; i < _positions.size(); ++i)
+    {
+        float angle = atan2(_cameraPosition.x() - _positions.x[i],
+                            _cameraPosition.z() - _positions.z[i]);
+
+        QMatrix4x4& modelMatrix = _modelMatrices[i];
+        modelMatrix.setToIdentity();
+        modelMatrix.translate(_positions.x[i], _positions.y[i], _positions.z[i]);
+        modelMatrix.scale(_positions.scale[i]);
+        modelMatrix.rotate(angle * 180 / M_PI, QVector3D(0.0f, 1.0f, 0.0f));
+        modelMatrix.rotate(90, QVector3D(1.0f, 0.0f, 0.0f));
+    }
+
+    return (double)timer.nsecsElapsed() * 1e-6;
+}
+
+//------------------------------------------------------------------------------------------
+double benchmarkKernel(const BillboardPositionSoA& _positions,
+                      const QVector3D& _cameraPosition,
+                      QVector<float>& _yawAngles,
+                      QVector<float>& _modelMatrices)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    BillboardOrientation::computeModelMatrices(_positions, _cameraPosition,
+                                               _yawAngles.data(), _modelMatrices.data());
+
+    return (double)timer.nsecsElapsed() * 1e-6;
+}
+
+//------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+#if defined(__AVX__)
+    out << "Kernel instruction set: AVX\n";
+#elif defined(__SSE2__)
+    out << "Kernel instruction set: SSE2\n";
+#else
+    out << "Kernel instruction set: scalar\n";
+#endif
+
+    const int numBillboards[] = {1000, 100000, 1000000};
+    const QVector3D cameraPosition(-4.0f,  5.0f, 15.0f);
+
+    out << "billboards\tQMatrix4x4 (ms)\tkernel (ms)\tspeedup\tmax matrix error\n";
+
+    for(int n : numBillboards)
+    {
+        BillboardPositionSoA positions;
+        generatePositions(positions, n);
+
+        QVector<QMatrix4x4> referenceMatrices(n);
+        QVector<float> yawAngles(n);
+        QVector<float> modelMatrices(12 * n);
+
+        double referenceTime = 1e30;
+        double kernelTime = 1e30;
+
+        for(int r = 0; r < NUM_REPEATS; ++r)
+        {
+            referenceTime = qMin(referenceTime,
+                                 benchmarkQMatrix4x4(positions, cameraPosition, referenceMatrices));
+            kernelTime = qMin(kernelTime,
+                              benchmarkKernel(positions, cameraPosition, yawAngles, modelMatrices));
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // validate the kernel against the reference matrices
+        float maxError = 0.0f;
+
+        for(int i = 0; i < n; ++i)
+        {
+            for(int row = 0; row < 3; ++row)
+            {
+                for(int col = 0; col < 4; ++col)
+                {
+                    float error = fabs(referenceMatrices[i](row, col) - modelMatrices[12 * i + 4 * row + col]);
+                    maxError = qMax(maxError, error);
+                }
+            }
+        }
+
+        out << n << "\t" << referenceTime << "\t" << kernelTime << "\t"
+            << referenceTime / kernelTime << "\t" << maxError << "\n";
+        // the large sizes take a while, print each row as soon as it is measured
+        out.flush();
+    }
+
+    return 0;
+}
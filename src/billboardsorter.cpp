@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------------------
+// billboardsorter.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+#include "billboardsorter.h"
+
+// at most this many element moves per element are spent to repair the previous order
+#define SORT_REPAIR_BUDGET 4
+
+//------------------------------------------------------------------------------------------
+BillboardSorter::BillboardSorter():
+    numThreads(qMax(1, QThread::idealThreadCount()))
+{
+}
+
+//------------------------------------------------------------------------------------------
+int BillboardSorter::getNumChunks(int _numInstances) const
+{
+    return qBound(1, _numInstances / SORT_MIN_INSTANCES_PER_THREAD, numThreads);
+}
+
+//------------------------------------------------------------------------------------------
+void BillboardSorter::runChunks(int _numChunks, const std::function<void(int)>& _function)
+{
+    if(_numChunks == 1)
+    {
+        _function(0);
+        return;
+    }
+
+    QVector<int> chunks(_numChunks);
+
+    for(int i = 0; i < _numChunks; ++i)
+    {
+        chunks[i] = i;
+    }
+
+    QtConcurrent::blockingMap(chunks, [&_function](int & _chunk)
+    {
+        _function(_chunk);
+    });
+}
+
+//------------------------------------------------------------------------------------------
+BillboardSorter::SortResult BillboardSorter::sort(QVector<BillboardInstance>& _instances,
+                                                  int _numInstances,
+                                                  const QVector3D& _cameraPosition,
+                                                  const QVector3D& _viewDirection,
+                                                  float _maxDepth)
+{
+    SortResult result;
+
+    computeKeys(_instances, _numInstances, _cameraPosition, _viewDirection, _maxDepth);
+
+    if(previousOrder.size() == _numInstances && isSortedAlongPreviousOrder(_numInstances))
+    {
+        order = previousOrder;
+        result = REUSED_PREVIOUS_ORDER;
+    }
+    else if(previousOrder.size() == _numInstances && repairPreviousOrder(_numInstances))
+    {
+        result = REPAIRED_PREVIOUS_ORDER;
+    }
+    else
+    {
+        radixSort(_numInstances);
+        result = RADIX_SORTED;
+    }
+
+    gather(_instances, _numInstances);
+    previousOrder = order;
+
+    return result;
+}
+
+//------------------------------------------------------------------------------------------
+// larger view depth gives smaller key, so ascending keys draw back to front
+//------------------------------------------------------------------------------------------
+void BillboardSorter::computeKeys(const QVector<BillboardInstance>& _instances,
+                                  int _numInstances,
+                                  const QVector3D& _cameraPosition,
+                                  const QVector3D& _viewDirection,
+                                  float _maxDepth)
+{
+    keys.resize(_numInstances);
+
+    const int numChunks = getNumChunks(_numInstances);
+    const float maxKey = (float)((1 << SORT_KEY_BITS) - 1);
+    const float depthScale = maxKey / qMax(_maxDepth, 1e-6f);
+    const BillboardInstance* instances = _instances.constData();
+    quint16* keyData = keys.data();
+
+    runChunks(numChunks, [&](int _chunk)
+    {
+        int begin = (int)((qint64)_numInstances * _chunk / numChunks);
+        int end = (int)((qint64)_numInstances * (_chunk + 1) / numChunks);
+
+        for(int i = begin; i < end; ++i)
+        {
+            float depth = QVector3D::dotProduct(instances[i].position - _cameraPosition,
+                                                _viewDirection);
+            float quantized = qBound(0.0f, depth * depthScale, maxKey);
+            keyData[i] = (quint16)(maxKey - quantized);
+        }
+    });
+}
+
+//------------------------------------------------------------------------------------------
+bool BillboardSorter::isSortedAlongPreviousOrder(int _numInstances)
+{
+    const int numChunks = getNumChunks(_numInstances);
+    const quint16* keyData = keys.constData();
+    const int* previousOrderData = previousOrder.constData();
+    QVector<int> sorted(numChunks, 1);
+    int* sortedData = sorted.data();
+
+    runChunks(numChunks, [&](int _chunk)
+    {
+        int begin = (int)((qint64)_numInstances * _chunk / numChunks);
+        int end = qMin(_numInstances - 1,
+                       (int)((qint64)_numInstances * (_chunk + 1) / numChunks));
+
+        for(int i = begin; i < end; ++i)
+        {
+            if(keyData[previousOrderData[i]] > keyData[previousOrderData[i + 1]])
+            {
+                sortedData[_chunk] = 0;
+                return;
+            }
+        }
+    });
+
+    return !sorted.contains(0);
+}
+
+//------------------------------------------------------------------------------------------
+// insertion sort starting from the previous order, given up when it moves too much
+//------------------------------------------------------------------------------------------
+bool BillboardSorter::repairPreviousOrder(int _numInstances)
+{
+    order = previousOrder;
+
+    const quint16* keyData = keys.constData();
+    int* orderData = order.data();
+    qint64 budget = (qint64)SORT_REPAIR_BUDGET * _numInstances;
+
+    for(int i = 1; i < _numInstances; ++i)
+    {
+        int index = orderData[i];
+        quint16 key = keyData[index];
+        int j = i - 1;
+
+        while(j >= 0 && keyData[orderData[j]] > key)
+        {
+            orderData[j + 1] = orderData[j];
+            --j;
+
+            if(--budget < 0)
+            {
+                return false;
+            }
+        }
+
+        orderData[j + 1] = index;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+// stable LSD radix sort of (key, index) pairs, each pass:
+// per-thread histograms, exclusive prefix sums over (digit, thread), per-thread scatter
+//------------------------------------------------------------------------------------------
+void BillboardSorter::radixSort(int _numInstances)
+{
+    const int numChunks = getNumChunks(_numInstances);
+
+    order.resize(_numInstances);
+    tmpOrder.resize(_numInstances);
+    sortedKeys = keys;
+    tmpKeys.resize(_numInstances);
+    histograms.resize(numChunks * SORT_RADIX_SIZE);
+
+    for(int i = 0; i < _numInstances; ++i)
+    {
+        order[i] = i;
+    }
+
+    for(int shift = 0; shift < SORT_KEY_BITS; shift += SORT_RADIX_BITS)
+    {
+        const quint16* srcKeys = sortedKeys.constData();
+        const int* srcOrder = order.constData();
+        quint16* dstKeys = tmpKeys.data();
+        int* dstOrder = tmpOrder.data();
+        int* histogramData = histograms.data();
+
+        /////////////////////////////////////////////////////////////////
+        // count the digits of each chunk
+        runChunks(numChunks, [&](int _chunk)
+        {
+            int begin = (int)((qint64)_numInstances * _chunk / numChunks);
+            int end = (int)((qint64)_numInstances * (_chunk + 1) / numChunks);
+            int* histogram = &histogramData[_chunk * SORT_RADIX_SIZE];
+
+            memset(histogram, 0, SORT_RADIX_SIZE * sizeof(int));
+
+            for(int i = begin; i < end; ++i)
+            {
+                ++histogram[(srcKeys[i] >> shift) & (SORT_RADIX_SIZE - 1)];
+            }
+        });
+
+        /////////////////////////////////////////////////////////////////
+        // turn the counts into the output offsets of each chunk
+        int offset = 0;
+
+        for(int digit = 0; digit < SORT_RADIX_SIZE; ++digit)
+        {
+            for(int chunk = 0; chunk < numChunks; ++chunk)
+            {
+                int count = histogramData[chunk * SORT_RADIX_SIZE + digit];
+                histogramData[chunk * SORT_RADIX_SIZE + digit] = offset;
+                offset += count;
+            }
+        }
+
+        /////////////////////////////////////////////////////////////////
+        // scatter, each chunk keeps its elements in order
+        runChunks(numChunks, [&](int _chunk)
+        {
+            int begin = (int)((qint64)_numInstances * _chunk / numChunks);
+            int end = (int)((qint64)_numInstances * (_chunk + 1) / numChunks);
+            int* offsets = &histogramData[_chunk * SORT_RADIX_SIZE];
+
+            for(int i = begin; i < end; ++i)
+            {
+                int position = offsets[(srcKeys[i] >> shift) & (SORT_RADIX_SIZE - 1)]++;
+                dstKeys[position] = srcKeys[i];
+                dstOrder[position] = srcOrder[i];
+            }
+        });
+
+        sortedKeys.swap(tmpKeys);
+        order.swap(tmpOrder);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void BillboardSorter::gather(QVector<BillboardInstance>& _instances, int _numInstances)
+{
+    if(scratch.size() < _numInstances)
+    {
+        scratch.resize(_numInstances);
+    }
+
+    const int numChunks = getNumChunks(_numInstances);
+    const BillboardInstance* instances = _instances.constData();
+    const int* orderData = order.constData();
+    BillboardInstance* scratchData = scratch.data();
+
+    runChunks(numChunks, [&](int _chunk)
+    {
+        int begin = (int)((qint64)_numInstances * _chunk / numChunks);
+        int end = (int)((qint64)_numInstances * (_chunk + 1) / numChunks);
+
+        for(int i = begin; i < end; ++i)
+        {
+            scratchData[i] = instances[orderData[i]];
+        }
+    });
+
+    std::copy(scratchData, scratchData + _numInstances, _instances.data());
+}
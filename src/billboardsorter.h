@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------------------
+// billboardsorter.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef BILLBOARDSORTER_H
+#define BILLBOARDSORTER_H
+
+#include <QVector>
+#include <QVector3D>
+#include <functional>
+
+#include "billboardinstance.h"
+
+#define SORT_KEY_BITS 16
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX_SIZE (1 << SORT_RADIX_BITS)
+#define SORT_MIN_INSTANCES_PER_THREAD 4096
+
+//------------------------------------------------------------------------------------------
+// Back-to-front sorting of billboards by view-space depth.
+// The depths are quantized into 16 bit keys and sorted by a multi-threaded LSD radix sort.
+// The order of the previous frame is tried first: if it still sorts the keys,
+// or only needs a few local swaps, the radix sort is skipped.
+//------------------------------------------------------------------------------------------
+class BillboardSorter
+{
+public:
+    enum SortResult
+    {
+        // reported when the sorting is skipped, never returned by sort()
+        NOT_SORTED = 0,
+        REUSED_PREVIOUS_ORDER,
+        REPAIRED_PREVIOUS_ORDER,
+        RADIX_SORTED
+    };
+
+    BillboardSorter();
+
+    SortResult sort(QVector<BillboardInstance>& _instances, int _numInstances,
+                    const QVector3D& _cameraPosition, const QVector3D& _viewDirection,
+                    float _maxDepth);
+
+private:
+    void computeKeys(const QVector<BillboardInstance>& _instances, int _numInstances,
+                     const QVector3D& _cameraPosition, const QVector3D& _viewDirection,
+                     float _maxDepth);
+    bool isSortedAlongPreviousOrder(int _numInstances);
+    bool repairPreviousOrder(int _numInstances);
+    void radixSort(int _numInstances);
+    void gather(QVector<BillboardInstance>& _instances, int _numInstances);
+
+    int getNumChunks(int _numInstances) const;
+    void runChunks(int _numChunks, const std::function<void(int)>& _function);
+
+    int numThreads;
+    QVector<quint16> keys;
+    QVector<quint16> sortedKeys;
+    QVector<quint16> tmpKeys;
+    QVector<int> order;
+    QVector<int> tmpOrder;
+    QVector<int> previousOrder;
+    QVector<BillboardInstance> scratch;
+    QVector<int> histograms;
+};
+
+#endif // BILLBOARDSORTER_H
@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------------------
+// frameprofiler.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "frameprofiler.h"
+
+#define TRACE_PROCESS_ID 1
+#define TRACE_CPU_THREAD_ID 1
+#define TRACE_GPU_THREAD_ID 2
+
+//------------------------------------------------------------------------------------------
+FrameProfiler::FrameProfiler():
+    gl(NULL),
+    currentFrame(0),
+    activeSample(-1),
+    frameBegin(0)
+{
+    clock.start();
+}
+
+//------------------------------------------------------------------------------------------
+void FrameProfiler::create(QOpenGLFunctions_4_0_Core* _gl)
+{
+    gl = _gl;
+}
+
+//------------------------------------------------------------------------------------------
+// the slot of this frame was used PROFILER_FRAME_LATENCY frames ago,
+// its queries are read before being reused
+//------------------------------------------------------------------------------------------
+void FrameProfiler::beginFrame()
+{
+    currentFrame = (currentFrame + 1) % PROFILER_FRAME_LATENCY;
+    collectGPUTimes(frames[currentFrame]);
+    frames[currentFrame].samples.resize(0);
+
+    frameBegin = clock.nsecsElapsed();
+}
+
+//------------------------------------------------------------------------------------------
+void FrameProfiler::endFrame()
+{
+    qint64 frameEnd = clock.nsecsElapsed();
+    int scope = getScopeIndex("Frame");
+
+    statistics[scope].cpuTime += PROFILER_AVERAGE_WEIGHT *
+                                 ((double)(frameEnd - frameBegin) * 1e-6 - statistics[scope].cpuTime);
+    addTraceEvent(scope, false, frameBegin, frameEnd - frameBegin);
+}
+
+//------------------------------------------------------------------------------------------
+void FrameProfiler::beginScope(const char* _name)
+{
+    Q_ASSERT(activeSample < 0);
+    FrameSamples& frame = frames[currentFrame];
+
+    if(frame.queries.size() == frame.samples.size())
+    {
+        GLuint query;
+        gl->glGenQueries(1, &query);
+        frame.queries.append(query);
+    }
+
+    ScopeSample sample;
+    sample.scope = getScopeIndex(_name);
+    sample.query = frame.queries[frame.samples.size()];
+    sample.cpuBegin = clock.nsecsElapsed();
+
+    gl->glBeginQuery(GL_TIME_ELAPSED, sample.query);
+
+    activeSample = frame.samples.size();
+    frame.samples.append(sample);
+}
+
+//------------------------------------------------------------------------------------------
+void FrameProfiler::endScope()
+{
+    Q_ASSERT(activeSample >= 0);
+    gl->glEndQuery(GL_TIME_ELAPSED);
+
+    const ScopeSample& sample = frames[currentFrame].samples[activeSample];
+    qint64 cpuDuration = clock.nsecsElapsed() - sample.cpuBegin;
+    ProfileScopeStatistics& scopeStatistics = statistics[sample.scope];
+
+    scopeStatistics.cpuTime += PROFILER_AVERAGE_WEIGHT *
+                               ((double)cpuDuration * 1e-6 - scopeStatistics.cpuTime);
+    addTraceEvent(sample.scope, false, sample.cpuBegin, cpuDuration);
+
+    activeSample = -1;
+}
+
+//------------------------------------------------------------------------------------------
+// a query still not available after the frame latency is dropped rather than waited for
+//------------------------------------------------------------------------------------------
+void FrameProfiler::collectGPUTimes(FrameSamples& _frame)
+{
+    for(const ScopeSample& sample : _frame.samples)
+    {
+        GLuint available = GL_FALSE;
+        gl->glGetQueryObjectuiv(sample.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if(!available)
+        {
+            continue;
+        }
+
+        GLuint64 gpuDuration = 0;
+        gl->glGetQueryObjectui64v(sample.query, GL_QUERY_RESULT, &gpuDuration);
+
+        ProfileScopeStatistics& scopeStatistics = statistics[sample.scope];
+        scopeStatistics.gpuTime += PROFILER_AVERAGE_WEIGHT *
+                                   ((double)gpuDuration * 1e-6 - scopeStatistics.gpuTime);
+
+        // elapsed time queries have no timestamp, the GPU event starts with the CPU one
+        addTraceEvent(sample.scope, true, sample.cpuBegin, (qint64)gpuDuration);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+int FrameProfiler::getScopeIndex(const char* _name)
+{
+    QHash<QString, int>::const_iterator it = scopeIndices.constFind(QLatin1String(_name));
+
+    if(it != scopeIndices.constEnd())
+    {
+        return it.value();
+    }
+
+    ProfileScopeStatistics scopeStatistics;
+    scopeStatistics.name = QLatin1String(_name);
+    scopeStatistics.cpuTime = 0.0;
+    scopeStatistics.gpuTime = 0.0;
+
+    statistics.append(scopeStatistics);
+    scopeIndices.insert(scopeStatistics.name, statistics.size() - 1);
+
+    return statistics.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------
+// the oldest half of the events is dropped when the trace is full
+//------------------------------------------------------------------------------------------
+void FrameProfiler::addTraceEvent(int _scope, bool _gpu, qint64 _begin, qint64 _duration)
+{
+    if(traceEvents.size() >= PROFILER_MAX_TRACE_EVENTS)
+    {
+        traceEvents.remove(0, PROFILER_MAX_TRACE_EVENTS / 2);
+    }
+
+    TraceEvent event;
+    event.scope = _scope;
+    event.gpu = _gpu;
+    event.begin = _begin;
+    event.duration = _duration;
+    traceEvents.append(event);
+}
+
+//------------------------------------------------------------------------------------------
+QVector<ProfileScopeStatistics> FrameProfiler::getStatistics() const
+{
+    return statistics;
+}
+
+//------------------------------------------------------------------------------------------
+// Chrome trace event format: complete events ("X") with times in microseconds,
+// the CPU and GPU scopes are on two separate tracks
+//------------------------------------------------------------------------------------------
+bool FrameProfiler::exportChromeTrace(const QString& _fileName) const
+{
+    QJsonArray events;
+
+    QJsonObject cpuThreadName;
+    cpuThreadName["name"] = "thread_name";
+    cpuThreadName["ph"] = "M";
+    cpuThreadName["pid"] = TRACE_PROCESS_ID;
+    cpuThreadName["tid"] = TRACE_CPU_THREAD_ID;
+    cpuThreadName["args"] = QJsonObject {{"name", "CPU"}};
+    events.append(cpuThreadName);
+
+    QJsonObject gpuThreadName = cpuThreadName;
+    gpuThreadName["tid"] = TRACE_GPU_THREAD_ID;
+    gpuThreadName["args"] = QJsonObject {{"name", "GPU"}};
+    events.append(gpuThreadName);
+
+    for(const TraceEvent& traceEvent : traceEvents)
+    {
+        QJsonObject event;
+        event["name"] = statistics[traceEvent.scope].name;
+        event["cat"] = traceEvent.gpu ? "gpu" : "cpu";
+        event["ph"] = "X";
+        event["ts"] = (double)traceEvent.begin * 1e-3;
+        event["dur"] = (double)traceEvent.duration * 1e-3;
+        event["pid"] = TRACE_PROCESS_ID;
+        event["tid"] = traceEvent.gpu ? TRACE_GPU_THREAD_ID : TRACE_CPU_THREAD_ID;
+        events.append(event);
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+
+    QFile file(_fileName);
+
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    return file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) >= 0;
+}
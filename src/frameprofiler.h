@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------------------
+// frameprofiler.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QOpenGLFunctions_4_0_Core>
+#include <QString>
+#include <QVector>
+
+#define PROFILER_FRAME_LATENCY 4
+#define PROFILER_AVERAGE_WEIGHT 0.05
+#define PROFILER_MAX_TRACE_EVENTS 200000
+
+//------------------------------------------------------------------------------------------
+// rolling averages of a profiled pass, in ms
+//------------------------------------------------------------------------------------------
+struct ProfileScopeStatistics
+{
+    QString name;
+    double cpuTime;
+    double gpuTime;
+};
+
+//------------------------------------------------------------------------------------------
+// Per-pass CPU and GPU timers.
+// Each scope measures the CPU time with a monotonic clock and the GPU time with a
+// GL_TIME_ELAPSED query. The queries of a frame are read PROFILER_FRAME_LATENCY frames
+// later, when they are available, so the profiler never waits for the GPU.
+// Elapsed time queries cannot nest: the GPU scopes must follow each other.
+// The recorded events can be exported as a Chrome trace (chrome://tracing, Perfetto).
+//------------------------------------------------------------------------------------------
+class FrameProfiler
+{
+public:
+    FrameProfiler();
+
+    void create(QOpenGLFunctions_4_0_Core* _gl);
+
+    void beginFrame();
+    void endFrame();
+
+    void beginScope(const char* _name);
+    void endScope();
+
+    QVector<ProfileScopeStatistics> getStatistics() const;
+    bool exportChromeTrace(const QString& _fileName) const;
+
+private:
+    struct ScopeSample
+    {
+        int scope;
+        GLuint query;
+        qint64 cpuBegin;
+    };
+
+    struct FrameSamples
+    {
+        QVector<ScopeSample> samples;
+        QVector<GLuint> queries;
+    };
+
+    struct TraceEvent
+    {
+        int scope;
+        bool gpu;
+        qint64 begin;
+        qint64 duration;
+    };
+
+    int getScopeIndex(const char* _name);
+    void collectGPUTimes(FrameSamples& _frame);
+    void addTraceEvent(int _scope, bool _gpu, qint64 _begin, qint64 _duration);
+
+    QOpenGLFunctions_4_0_Core* gl;
+    QElapsedTimer clock;
+
+    FrameSamples frames[PROFILER_FRAME_LATENCY];
+    int currentFrame;
+    int activeSample;
+    qint64 frameBegin;
+
+    QHash<QString, int> scopeIndices;
+    QVector<ProfileScopeStatistics> statistics;
+    QVector<TraceEvent> traceEvents;
+};
+
+//------------------------------------------------------------------------------------------
+// profiles the enclosing block
+//------------------------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+    ProfileScope(FrameProfiler& _profiler, const char* _name):
+        profiler(_profiler)
+    {
+        profiler.beginScope(_name);
+    }
+
+    ~ProfileScope()
+    {
+        profiler.endScope();
+    }
+
+private:
+    FrameProfiler& profiler;
+};
+
+#endif // FRAMEPROFILER_H
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------------------
+// frustum.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include "frustum.h"
+
+//------------------------------------------------------------------------------------------
+Frustum::Frustum()
+{
+    for(int i = 0; i < NUM_PLANES; ++i)
+    {
+        planes[i] = QVector4D(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// Gribb-Hartmann plane extraction, the planes are normalized
+// so the plane equation gives the signed distance to a point
+//------------------------------------------------------------------------------------------
+void Frustum::extractPlanes(const QMatrix4x4& _viewProjectionMatrix)
+{
+    QVector4D row0 = _viewProjectionMatrix.row(0);
+    QVector4D row1 = _viewProjectionMatrix.row(1);
+    QVector4D row2 = _viewProjectionMatrix.row(2);
+    QVector4D row3 = _viewProjectionMatrix.row(3);
+
+    planes[LEFT_PLANE] = row3 + row0;
+    planes[RIGHT_PLANE] = row3 - row0;
+    planes[BOTTOM_PLANE] = row3 + row1;
+    planes[TOP_PLANE] = row3 - row1;
+    planes[NEAR_PLANE] = row3 + row2;
+    planes[FAR_PLANE] = row3 - row2;
+
+    for(int i = 0; i < NUM_PLANES; ++i)
+    {
+        float length = planes[i].toVector3D().length();
+
+        if(length > 1e-8f)
+        {
+            planes[i] /= length;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+const QVector4D& Frustum::getPlane(Plane _plane) const
+{
+    return planes[_plane];
+}
+
+//------------------------------------------------------------------------------------------
+bool Frustum::containsSphere(const QVector3D& _center, float _radius) const
+{
+    for(int i = 0; i < NUM_PLANES; ++i)
+    {
+        const QVector4D& plane = planes[i];
+
+        if(plane.x() * _center.x() + plane.y() * _center.y() + plane.z() * _center.z() +
+           plane.w() < -_radius)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+// test the box corners which are the farthest along and against each plane normal
+//------------------------------------------------------------------------------------------
+Frustum::Intersection Frustum::classifyBox(const QVector3D& _boxMin,
+                                           const QVector3D& _boxMax) const
+{
+    Intersection result = INSIDE;
+
+    for(int i = 0; i < NUM_PLANES; ++i)
+    {
+        const QVector4D& plane = planes[i];
+
+        float px = plane.x() > 0.0f ? _boxMax.x() : _boxMin.x();
+        float py = plane.y() > 0.0f ? _boxMax.y() : _boxMin.y();
+        float pz = plane.z() > 0.0f ? _boxMax.z() : _boxMin.z();
+
+        if(plane.x() * px + plane.y() * py + plane.z() * pz + plane.w() < 0.0f)
+        {
+            return OUTSIDE;
+        }
+
+        float nx = plane.x() > 0.0f ? _boxMin.x() : _boxMax.x();
+        float ny = plane.y() > 0.0f ? _boxMin.y() : _boxMax.y();
+        float nz = plane.z() > 0.0f ? _boxMin.z() : _boxMax.z();
+
+        if(plane.x() * nx + plane.y() * ny + plane.z() * nz + plane.w() < 0.0f)
+        {
+            result = INTERSECT;
+        }
+    }
+
+    return result;
+}
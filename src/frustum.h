@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------------------
+// frustum.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <QVector4D>
+
+//------------------------------------------------------------------------------------------
+// view frustum planes, extracted from a view-projection matrix.
+// Plane normals point inside the frustum.
+//------------------------------------------------------------------------------------------
+class Frustum
+{
+public:
+    enum Intersection
+    {
+        OUTSIDE = 0,
+        INTERSECT,
+        INSIDE
+    };
+
+    enum Plane
+    {
+        LEFT_PLANE = 0,
+        RIGHT_PLANE,
+        BOTTOM_PLANE,
+        TOP_PLANE,
+        NEAR_PLANE,
+        FAR_PLANE,
+        NUM_PLANES
+    };
+
+    Frustum();
+
+    void extractPlanes(const QMatrix4x4& _viewProjectionMatrix);
+    const QVector4D& getPlane(Plane _plane) const;
+
+    bool containsSphere(const QVector3D& _center, float _radius) const;
+    Intersection classifyBox(const QVector3D& _boxMin, const QVector3D& _boxMax) const;
+
+private:
+    QVector4D planes[NUM_PLANES];
+};
+
+#endif // FRUSTUM_H
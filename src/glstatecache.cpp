@@ -0,0 +1,314 @@
+//------------------------------------------------------------------------------------------
+// glstatecache.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include "glstatecache.h"
+
+// value which no GL call sets, so the first call after an invalidation is always issued
+#define UNKNOWN_STATE 0xFFFFFFFFu
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+
+//------------------------------------------------------------------------------------------
+GLStateCache::GLStateCache():
+    gl(NULL),
+    numIssuedCalls(0),
+    numSkippedCalls(0)
+{
+    invalidate();
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::create(QOpenGLFunctions_4_0_Core* _gl)
+{
+    gl = _gl;
+    invalidate();
+}
+
+//------------------------------------------------------------------------------------------
+// uniforms and block bindings are kept: they belong to the programs, not to the context
+//------------------------------------------------------------------------------------------
+void GLStateCache::invalidate()
+{
+    currentProgram = UNKNOWN_STATE;
+    currentVertexArray = UNKNOWN_STATE;
+    activeTextureUnit = -1;
+    blendSrcFactor = UNKNOWN_STATE;
+    blendDstFactor = UNKNOWN_STATE;
+
+    for(int i = 0; i < MAX_CACHED_TEXTURE_UNITS; ++i)
+    {
+        boundTextures[i] = UNKNOWN_STATE;
+    }
+
+    for(int i = 0; i < MAX_CACHED_UNIFORM_BINDINGS; ++i)
+    {
+        uniformBufferBindings[i].buffer = UNKNOWN_STATE;
+    }
+
+    capabilities.clear();
+    textureAnisotropies.clear();
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::beginFrame()
+{
+    numIssuedCalls = 0;
+    numSkippedCalls = 0;
+}
+
+//------------------------------------------------------------------------------------------
+int GLStateCache::getNumIssuedCalls() const
+{
+    return numIssuedCalls;
+}
+
+//------------------------------------------------------------------------------------------
+int GLStateCache::getNumSkippedCalls() const
+{
+    return numSkippedCalls;
+}
+
+//------------------------------------------------------------------------------------------
+bool GLStateCache::skip(bool _redundant)
+{
+    if(_redundant)
+    {
+        ++numSkippedCalls;
+    }
+    else
+    {
+        ++numIssuedCalls;
+    }
+
+    return _redundant;
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::useProgram(QOpenGLShaderProgram* _program)
+{
+    if(skip(currentProgram == _program->programId()))
+    {
+        return;
+    }
+
+    _program->bind();
+    currentProgram = _program->programId();
+}
+
+//------------------------------------------------------------------------------------------
+// the program is bound if needed, the uniform value is kept by the program
+//------------------------------------------------------------------------------------------
+void GLStateCache::setUniform(QOpenGLShaderProgram* _program, GLint _location, GLint _value)
+{
+    QPair<GLuint, GLint> key(_program->programId(), _location);
+    QHash<QPair<GLuint, GLint>, GLint>::const_iterator it = uniforms.constFind(key);
+
+    if(skip(it != uniforms.constEnd() && it.value() == _value))
+    {
+        return;
+    }
+
+    useProgram(_program);
+    _program->setUniformValue(_location, _value);
+    uniforms.insert(key, _value);
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::uniformBlockBinding(QOpenGLShaderProgram* _program, GLuint _blockIndex,
+                                       GLuint _bindingIndex)
+{
+    QPair<GLuint, GLuint> key(_program->programId(), _blockIndex);
+    QHash<QPair<GLuint, GLuint>, GLuint>::const_iterator it =
+        uniformBlockBindings.constFind(key);
+
+    if(skip(it != uniformBlockBindings.constEnd() && it.value() == _bindingIndex))
+    {
+        return;
+    }
+
+    gl->glUniformBlockBinding(_program->programId(), _blockIndex, _bindingIndex);
+    uniformBlockBindings.insert(key, _bindingIndex);
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::bindVertexArray(QOpenGLVertexArrayObject& _vao)
+{
+    if(skip(currentVertexArray == _vao.objectId()))
+    {
+        return;
+    }
+
+    _vao.bind();
+    currentVertexArray = _vao.objectId();
+}
+
+//------------------------------------------------------------------------------------------
+// leaving a vertex array bound would let later buffer setup code modify it
+//------------------------------------------------------------------------------------------
+void GLStateCache::unbindVertexArray()
+{
+    if(skip(currentVertexArray == 0))
+    {
+        return;
+    }
+
+    gl->glBindVertexArray(0);
+    currentVertexArray = 0;
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::bindTexture(int _unit, QOpenGLTexture* _texture)
+{
+    bindTexture(_unit, _texture->target(), _texture->textureId());
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::bindTexture(int _unit, GLenum _target, GLuint _textureId)
+{
+    Q_ASSERT(_unit < MAX_CACHED_TEXTURE_UNITS);
+
+    if(skip(boundTextures[_unit] == _textureId))
+    {
+        return;
+    }
+
+    if(activeTextureUnit != _unit)
+    {
+        gl->glActiveTexture(GL_TEXTURE0 + _unit);
+        activeTextureUnit = _unit;
+    }
+
+    gl->glBindTexture(_target, _textureId);
+    boundTextures[_unit] = _textureId;
+}
+
+//------------------------------------------------------------------------------------------
+// the anisotropy is a texture parameter, so it is cached per texture
+//------------------------------------------------------------------------------------------
+void GLStateCache::setTextureMaxAnisotropy(int _unit, QOpenGLTexture* _texture,
+                                           GLfloat _anisotropy)
+{
+    QHash<GLuint, GLfloat>::const_iterator it = textureAnisotropies.constFind(
+                                                    _texture->textureId());
+
+    if(skip(it != textureAnisotropies.constEnd() && it.value() == _anisotropy))
+    {
+        return;
+    }
+
+    bindTexture(_unit, _texture);
+
+    if(activeTextureUnit != _unit)
+    {
+        gl->glActiveTexture(GL_TEXTURE0 + _unit);
+        activeTextureUnit = _unit;
+    }
+
+    gl->glTexParameterf(_texture->target(), GL_TEXTURE_MAX_ANISOTROPY_EXT, _anisotropy);
+    textureAnisotropies.insert(_texture->textureId(), _anisotropy);
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::bindUniformBufferBase(GLuint _bindingIndex, GLuint _buffer)
+{
+    Q_ASSERT(_bindingIndex < MAX_CACHED_UNIFORM_BINDINGS);
+    UniformBufferBinding& binding = uniformBufferBindings[_bindingIndex];
+
+    // a base binding is cached as a range of size 0
+    if(skip(binding.buffer == _buffer && binding.size == 0))
+    {
+        return;
+    }
+
+    gl->glBindBufferBase(GL_UNIFORM_BUFFER, _bindingIndex, _buffer);
+    binding.buffer = _buffer;
+    binding.offset = 0;
+    binding.size = 0;
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::bindUniformBufferRange(GLuint _bindingIndex, GLuint _buffer,
+                                          GLintptr _offset, GLsizeiptr _size)
+{
+    Q_ASSERT(_bindingIndex < MAX_CACHED_UNIFORM_BINDINGS);
+    UniformBufferBinding& binding = uniformBufferBindings[_bindingIndex];
+
+    if(skip(binding.buffer == _buffer && binding.offset == _offset && binding.size == _size))
+    {
+        return;
+    }
+
+    gl->glBindBufferRange(GL_UNIFORM_BUFFER, _bindingIndex, _buffer, _offset, _size);
+    binding.buffer = _buffer;
+    binding.offset = _offset;
+    binding.size = _size;
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::setCapability(GLenum _capability, bool _enabled)
+{
+    QHash<GLenum, bool>::const_iterator it = capabilities.constFind(_capability);
+
+    if(skip(it != capabilities.constEnd() && it.value() == _enabled))
+    {
+        return;
+    }
+
+    if(_enabled)
+    {
+        gl->glEnable(_capability);
+    }
+    else
+    {
+        gl->glDisable(_capability);
+    }
+
+    capabilities.insert(_capability, _enabled);
+}
+
+//------------------------------------------------------------------------------------------
+bool GLStateCache::isEnabled(GLenum _capability)
+{
+    QHash<GLenum, bool>::const_iterator it = capabilities.constFind(_capability);
+
+    if(it != capabilities.constEnd())
+    {
+        return it.value();
+    }
+
+    bool enabled = gl->glIsEnabled(_capability) == GL_TRUE;
+    capabilities.insert(_capability, enabled);
+
+    return enabled;
+}
+
+//------------------------------------------------------------------------------------------
+void GLStateCache::blendFunc(GLenum _srcFactor, GLenum _dstFactor)
+{
+    if(skip(blendSrcFactor == _srcFactor && blendDstFactor == _dstFactor))
+    {
+        return;
+    }
+
+    gl->glBlendFunc(_srcFactor, _dstFactor);
+    blendSrcFactor = _srcFactor;
+    blendDstFactor = _dstFactor;
+}
+
+//------------------------------------------------------------------------------------------
+// a per draw buffer function leaves the global one unknown
+//------------------------------------------------------------------------------------------
+void GLStateCache::blendFunci(GLuint _drawBuffer, GLenum _srcFactor, GLenum _dstFactor)
+{
+    skip(false);
+    gl->glBlendFunci(_drawBuffer, _srcFactor, _dstFactor);
+    blendSrcFactor = UNKNOWN_STATE;
+    blendDstFactor = UNKNOWN_STATE;
+}
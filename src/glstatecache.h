@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------------------
+// glstatecache.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <QHash>
+#include <QOpenGLFunctions_4_0_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QOpenGLVertexArrayObject>
+#include <QPair>
+
+#define MAX_CACHED_TEXTURE_UNITS 8
+#define MAX_CACHED_UNIFORM_BINDINGS 16
+
+//------------------------------------------------------------------------------------------
+// Shadow copy of the GL state changed while rendering: program, vertex array, textures,
+// uniform buffer bindings, uniform block bindings, integer uniforms, capabilities,
+// blend function and texture anisotropy.
+// A call matching the cached value is skipped, the issued and skipped calls are counted
+// per frame. State changed behind the cache (by Qt or by uploads) must be invalidated.
+//------------------------------------------------------------------------------------------
+class GLStateCache
+{
+public:
+    GLStateCache();
+
+    void create(QOpenGLFunctions_4_0_Core* _gl);
+    void invalidate();
+
+    void beginFrame();
+    int getNumIssuedCalls() const;
+    int getNumSkippedCalls() const;
+
+    void useProgram(QOpenGLShaderProgram* _program);
+    void setUniform(QOpenGLShaderProgram* _program, GLint _location, GLint _value);
+    void uniformBlockBinding(QOpenGLShaderProgram* _program, GLuint _blockIndex,
+                             GLuint _bindingIndex);
+
+    void bindVertexArray(QOpenGLVertexArrayObject& _vao);
+    void unbindVertexArray();
+
+    void bindTexture(int _unit, QOpenGLTexture* _texture);
+    void bindTexture(int _unit, GLenum _target, GLuint _textureId);
+    void setTextureMaxAnisotropy(int _unit, QOpenGLTexture* _texture, GLfloat _anisotropy);
+
+    void bindUniformBufferBase(GLuint _bindingIndex, GLuint _buffer);
+    void bindUniformBufferRange(GLuint _bindingIndex, GLuint _buffer,
+                                GLintptr _offset, GLsizeiptr _size);
+
+    void setCapability(GLenum _capability, bool _enabled);
+    bool isEnabled(GLenum _capability);
+    void blendFunc(GLenum _srcFactor, GLenum _dstFactor);
+    void blendFunci(GLuint _drawBuffer, GLenum _srcFactor, GLenum _dstFactor);
+
+private:
+    bool skip(bool _redundant);
+
+    struct UniformBufferBinding
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    QOpenGLFunctions_4_0_Core* gl;
+
+    GLuint currentProgram;
+    GLuint currentVertexArray;
+    int activeTextureUnit;
+    GLuint boundTextures[MAX_CACHED_TEXTURE_UNITS];
+    UniformBufferBinding uniformBufferBindings[MAX_CACHED_UNIFORM_BINDINGS];
+    GLenum blendSrcFactor;
+    GLenum blendDstFactor;
+
+    QHash<GLenum, bool> capabilities;
+    QHash<QPair<GLuint, GLint>, GLint> uniforms;
+    QHash<QPair<GLuint, GLuint>, GLuint> uniformBlockBindings;
+    QHash<GLuint, GLfloat> textureAnisotropies;
+
+    int numIssuedCalls;
+    int numSkippedCalls;
+};
+
+#endif // GLSTATECACHE_H
@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------------------
+// gridmesh.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QtConcurrent>
+
+#include "gridmesh.h"
+
+//------------------------------------------------------------------------------------------
+GridMesh::GridMesh():
+    numCellsX(0),
+    numCellsZ(0),
+    numIndices(0),
+    indexType(GL_UNSIGNED_SHORT),
+    heightmapWidth(0),
+    heightmapHeight(0),
+    heightmapBorder(0)
+{
+}
+
+//------------------------------------------------------------------------------------------
+void GridMesh::setHeightmap(const QImage& _heightmap, float _heightScale)
+{
+    QImage grayscale = _heightmap.convertToFormat(QImage::Format_Grayscale8);
+    QVector<float> heights(grayscale.width() * grayscale.height());
+
+    for(int y = 0; y < grayscale.height(); ++y)
+    {
+        const uchar* row = grayscale.constScanLine(y);
+
+        for(int x = 0; x < grayscale.width(); ++x)
+        {
+            heights[y * grayscale.width() + x] = (float)row[x] / 255.0f * _heightScale;
+        }
+    }
+
+    setHeightmap(heights, grayscale.width(), grayscale.height());
+}
+
+//------------------------------------------------------------------------------------------
+void GridMesh::setHeightmap(const QVector<float>& _heights, int _width, int _height,
+                            int _border)
+{
+    Q_ASSERT(_heights.size() == _width * _height);
+    Q_ASSERT(_width > 2 * _border && _height > 2 * _border);
+
+    heightmap = _heights;
+    heightmapWidth = _width;
+    heightmapHeight = _height;
+    heightmapBorder = _border;
+}
+
+//------------------------------------------------------------------------------------------
+void GridMesh::clearHeightmap()
+{
+    heightmap.clear();
+    heightmapWidth = 0;
+    heightmapHeight = 0;
+    heightmapBorder = 0;
+}
+
+//------------------------------------------------------------------------------------------
+void GridMesh::generate(int _numCellsX, int _numCellsZ, const VertexFormat& _format)
+{
+    numCellsX = qMax(1, _numCellsX);
+    numCellsZ = qMax(1, _numCellsZ);
+
+    int numVertices = getNumVertices();
+    numIndices = 6 * numCellsX * numCellsZ;
+    indexType = (numVertices <= 65536) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    vertices = QByteArray(numVertices * _format.getStride(), 0);
+    indices = QByteArray(numIndices * (indexType == GL_UNSIGNED_SHORT ?
+                                       sizeof(GLushort) : sizeof(GLuint)), 0);
+
+    // the buffers are detached once, before the tasks write into them
+    uchar* vertexData = reinterpret_cast<uchar*>(vertices.data());
+    char* indexData = indices.data();
+
+    /////////////////////////////////////////////////////////////////
+    // vertex rows
+    QVector<int> firstRows;
+
+    for(int row = 0; row <= numCellsZ; row += GRID_MIN_ROWS_PER_TASK)
+    {
+        firstRows.append(row);
+    }
+
+    QtConcurrent::blockingMap(firstRows, [this, &_format, vertexData](int & _firstRow)
+    {
+        generateVertexRows(_firstRow, qMin(_firstRow + GRID_MIN_ROWS_PER_TASK, numCellsZ + 1),
+                           _format, vertexData);
+    });
+
+    /////////////////////////////////////////////////////////////////
+    // index strips, each one writes its own range of the index buffer
+    QVector<int> strips;
+
+    for(int strip = 0; strip * GRID_INDEX_STRIP_WIDTH < numCellsX; ++strip)
+    {
+        strips.append(strip);
+    }
+
+    QtConcurrent::blockingMap(strips, [this, indexData](int & _strip)
+    {
+        if(indexType == GL_UNSIGNED_SHORT)
+        {
+            generateIndexStrip(_strip, reinterpret_cast<GLushort*>(indexData));
+        }
+        else
+        {
+            generateIndexStrip(_strip, reinterpret_cast<GLuint*>(indexData));
+        }
+    });
+}
+
+//------------------------------------------------------------------------------------------
+// the normals come from the central differences of the heightmap
+//------------------------------------------------------------------------------------------
+void GridMesh::generateVertexRows(int _firstRow, int _lastRow, const VertexFormat& _format,
+                                  uchar* _vertices) const
+{
+    float du = 1.0f / (float)numCellsX;
+    float dv = 1.0f / (float)numCellsZ;
+    int stride = _format.getStride();
+
+    for(int j = _firstRow; j < _lastRow; ++j)
+    {
+        uchar* vertex = _vertices + j * (numCellsX + 1) * stride;
+        float v = (float)j * dv;
+
+        for(int i = 0; i <= numCellsX; ++i)
+        {
+            float u = (float)i * du;
+            QVector3D position(2.0f * u - 1.0f, getHeight(u, v), 2.0f * v - 1.0f);
+            QVector3D normal(0.0f, 1.0f, 0.0f);
+
+            if(!heightmap.isEmpty())
+            {
+                float dhdx = (getHeight(u + du, v) - getHeight(u - du, v)) / (4.0f * du);
+                float dhdz = (getHeight(u, v + dv) - getHeight(u, v - dv)) / (4.0f * dv);
+                normal = QVector3D(-dhdx, 1.0f, -dhdz).normalized();
+            }
+
+            _format.writeVertex(position, normal, QVector2D(u, v), vertex);
+            vertex += stride;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// Cache-friendly order: the cells are walked row by row inside vertical strips of
+// GRID_INDEX_STRIP_WIDTH columns, the triangles have the winding of UnitPlane.
+//------------------------------------------------------------------------------------------
+template<class IndexType>
+void GridMesh::generateIndexStrip(int _strip, IndexType* _indices) const
+{
+    int firstColumn = _strip * GRID_INDEX_STRIP_WIDTH;
+    int lastColumn = qMin(firstColumn + GRID_INDEX_STRIP_WIDTH, numCellsX);
+    int rowSize = numCellsX + 1;
+
+    IndexType* index = _indices + 6 * firstColumn * numCellsZ;
+
+    for(int j = 0; j < numCellsZ; ++j)
+    {
+        for(int i = firstColumn; i < lastColumn; ++i)
+        {
+            IndexType v00 = (IndexType)(j * rowSize + i);
+            IndexType v10 = v00 + 1;
+            IndexType v01 = (IndexType)(v00 + rowSize);
+            IndexType v11 = v01 + 1;
+
+            *index++ = v00;
+            *index++ = v10;
+            *index++ = v11;
+            *index++ = v11;
+            *index++ = v01;
+            *index++ = v00;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// bilinear sample of the heightmap, [0, 1] maps to the samples inside the border,
+// beyond it the samples are clamped to the edge of the heightmap
+//------------------------------------------------------------------------------------------
+float GridMesh::getHeight(float _u, float _v) const
+{
+    if(heightmap.isEmpty())
+    {
+        return 0.0f;
+    }
+
+    float x = qBound(0.0f, (float)heightmapBorder +
+                     _u * (float)(heightmapWidth - 1 - 2 * heightmapBorder),
+                     (float)(heightmapWidth - 1));
+    float y = qBound(0.0f, (float)heightmapBorder +
+                     _v * (float)(heightmapHeight - 1 - 2 * heightmapBorder),
+                     (float)(heightmapHeight - 1));
+    int x0 = (int)x;
+    int y0 = (int)y;
+    int x1 = qMin(x0 + 1, heightmapWidth - 1);
+    int y1 = qMin(y0 + 1, heightmapHeight - 1);
+    float fx = x - (float)x0;
+    float fy = y - (float)y0;
+
+    const float* row0 = heightmap.constData() + y0 * heightmapWidth;
+    const float* row1 = heightmap.constData() + y1 * heightmapWidth;
+
+    return (1.0f - fy) * ((1.0f - fx) * row0[x0] + fx * row0[x1]) +
+           fy * ((1.0f - fx) * row1[x0] + fx * row1[x1]);
+}
+
+//------------------------------------------------------------------------------------------
+int GridMesh::getNumCellsX() const
+{
+    return numCellsX;
+}
+
+//------------------------------------------------------------------------------------------
+int GridMesh::getNumCellsZ() const
+{
+    return numCellsZ;
+}
+
+//------------------------------------------------------------------------------------------
+int GridMesh::getNumVertices() const
+{
+    return (numCellsX + 1) * (numCellsZ + 1);
+}
+
+//------------------------------------------------------------------------------------------
+int GridMesh::getNumIndices() const
+{
+    return numIndices;
+}
+
+//------------------------------------------------------------------------------------------
+GLenum GridMesh::getIndexType() const
+{
+    return indexType;
+}
+
+//------------------------------------------------------------------------------------------
+const QByteArray& GridMesh::getVertices() const
+{
+    return vertices;
+}
+
+//------------------------------------------------------------------------------------------
+const QByteArray& GridMesh::getIndices() const
+{
+    return indices;
+}
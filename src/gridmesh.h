@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------------------
+// gridmesh.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef GRIDMESH_H
+#define GRIDMESH_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QVector>
+
+#include "vertexformat.h"
+
+// columns of cells per strip of the index buffer, the vertices of one strip row
+// stay in the post-transform cache until the next row reuses them
+#define GRID_INDEX_STRIP_WIDTH 16
+#define GRID_MIN_ROWS_PER_TASK 16
+
+//------------------------------------------------------------------------------------------
+// Tessellated ground grid over [-1, 1] x [-1, 1] in the xz plane, same orientation and
+// texture coordinates as UnitPlane, optionally displaced along y by a heightmap.
+// The vertex rows and the index strips are generated in parallel. The indices are
+// 16-bit while the vertices fit, 32-bit otherwise.
+//------------------------------------------------------------------------------------------
+class GridMesh
+{
+public:
+    GridMesh();
+
+    void generate(int _numCellsX, int _numCellsZ, const VertexFormat& _format);
+
+    // the gray level of the image scaled by _heightScale, applied on the next generate()
+    void setHeightmap(const QImage& _heightmap, float _heightScale);
+    // row-major heights, in the units of the grid. The grid spans the samples inside a
+    // border of _border samples, which the normals of the edge vertices read from, so that
+    // neighbouring grids sampled with an apron get the same normals along their edges
+    void setHeightmap(const QVector<float>& _heights, int _width, int _height,
+                      int _border = 0);
+    void clearHeightmap();
+
+    int getNumCellsX() const;
+    int getNumCellsZ() const;
+    int getNumVertices() const;
+    int getNumIndices() const;
+    GLenum getIndexType() const;
+
+    const QByteArray& getVertices() const;
+    const QByteArray& getIndices() const;
+
+private:
+    float getHeight(float _u, float _v) const;
+    void generateVertexRows(int _firstRow, int _lastRow, const VertexFormat& _format,
+                            uchar* _vertices) const;
+    template<class IndexType> void generateIndexStrip(int _strip, IndexType* _indices) const;
+
+    int numCellsX;
+    int numCellsZ;
+    int numIndices;
+    GLenum indexType;
+
+    QVector<float> heightmap;
+    int heightmapWidth;
+    int heightmapHeight;
+    int heightmapBorder;
+
+    QByteArray vertices;
+    QByteArray indices;
+};
+
+#endif // GRIDMESH_H
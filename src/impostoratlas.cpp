@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------------------
+// impostoratlas.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QOpenGLShaderProgram>
+
+#include "impostoratlas.h"
+#include "texturecache.h"
+
+//------------------------------------------------------------------------------------------
+ImpostorAtlas::ImpostorAtlas():
+    gl(NULL),
+    texture(NULL),
+    loadedFromCache(false)
+{
+}
+
+//------------------------------------------------------------------------------------------
+ImpostorAtlas::~ImpostorAtlas()
+{
+    delete texture;
+}
+
+//------------------------------------------------------------------------------------------
+// load the cached atlas of this mesh, or bake it and fill the cache
+//------------------------------------------------------------------------------------------
+bool ImpostorAtlas::create(QOpenGLFunctions_4_0_Core* _gl, const TreeMesh& _mesh,
+                           GLuint _framebuffer)
+{
+    gl = _gl;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    createTexture();
+
+    QString cachedFile = getCachedFileName(_mesh);
+    loadedFromCache = load(cachedFile);
+
+    if(!loadedFromCache)
+    {
+        if(!bake(_mesh, _framebuffer))
+        {
+            return false;
+        }
+
+        save(cachedFile);
+    }
+
+    texture->generateMipMaps();
+
+    qDebug() << "Impostor atlas:" << (loadedFromCache ? "loaded from cache" : "baked")
+             << "in" << (double)timer.nsecsElapsed() * 1e-6 << "ms";
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+QOpenGLTexture* ImpostorAtlas::getTexture() const
+{
+    return texture;
+}
+
+//------------------------------------------------------------------------------------------
+int ImpostorAtlas::getGridSize() const
+{
+    return IMPOSTOR_GRID_SIZE;
+}
+
+//------------------------------------------------------------------------------------------
+bool ImpostorAtlas::isLoadedFromCache() const
+{
+    return loadedFromCache;
+}
+
+//------------------------------------------------------------------------------------------
+int ImpostorAtlas::getAtlasSize()
+{
+    return IMPOSTOR_GRID_SIZE * IMPOSTOR_CELL_SIZE;
+}
+
+//------------------------------------------------------------------------------------------
+// the file is named after the mesh data and the atlas layout,
+// a changed mesh or layout never reads a stale atlas
+//------------------------------------------------------------------------------------------
+QString ImpostorAtlas::getCachedFileName(const TreeMesh& _mesh)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char*>(_mesh.getVertices().constData()),
+                 _mesh.getVertices().size() * sizeof(GLfloat));
+    hash.addData(reinterpret_cast<const char*>(_mesh.getIndices().constData()),
+                 _mesh.getNumIndices() * sizeof(GLushort));
+    hash.addData(QString("grid=%1,cell=%2,version=%3").arg(IMPOSTOR_GRID_SIZE).arg(
+                     IMPOSTOR_CELL_SIZE).arg(IMPOSTOR_CACHE_VERSION).toUtf8());
+
+    return QString("%1/impostor-%2.png").arg(TextureCache::getCacheDirectory()).arg(
+               QString(hash.result().toHex()));
+}
+
+//------------------------------------------------------------------------------------------
+void ImpostorAtlas::createTexture()
+{
+    delete texture;
+
+    texture = new QOpenGLTexture(QOpenGLTexture::Target2DArray);
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setSize(getAtlasSize(), getAtlasSize());
+    texture->setLayers(2);
+    texture->setMipLevels(IMPOSTOR_MIP_LEVELS);
+    texture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+    texture->setMinMagFilters(QOpenGLTexture::LinearMipMapLinear, QOpenGLTexture::Linear);
+    texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+}
+
+//------------------------------------------------------------------------------------------
+// the two layers are stacked vertically in the cached image
+//------------------------------------------------------------------------------------------
+bool ImpostorAtlas::load(const QString& _fileName)
+{
+    QImage image(_fileName);
+
+    if(image.isNull() || image.width() != getAtlasSize() || image.height() != 2 * getAtlasSize())
+    {
+        return false;
+    }
+
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+
+    texture->bind();
+    gl->glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, getAtlasSize(), getAtlasSize(), 2,
+                        GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+    texture->release();
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+bool ImpostorAtlas::save(const QString& _fileName)
+{
+    QImage image(getAtlasSize(), 2 * getAtlasSize(), QImage::Format_RGBA8888);
+
+    texture->bind();
+    gl->glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+    texture->release();
+
+    QDir().mkpath(QFileInfo(_fileName).absolutePath());
+
+    // the extension tells the image format, the temporary name keeps it
+    QString tmpFileName = _fileName + ".tmp.png";
+
+    if(!image.save(tmpFileName))
+    {
+        qDebug() << "Cannot write impostor cache file:" << tmpFileName;
+        return false;
+    }
+
+    QFile::remove(_fileName);
+
+    return QFile::rename(tmpFileName, _fileName);
+}
+
+//------------------------------------------------------------------------------------------
+// one instance per view, each one clipped to its cell of the atlas
+//------------------------------------------------------------------------------------------
+bool ImpostorAtlas::bake(const TreeMesh& _mesh, GLuint _framebuffer)
+{
+    QOpenGLShaderProgram program;
+
+    if(!program.addShaderFromSourceFile(QOpenGLShader::Vertex,
+                                        ":/shaders/impostor-bake.vs.glsl") ||
+       !program.addShaderFromSourceFile(QOpenGLShader::Fragment,
+                                        ":/shaders/impostor-bake.fs.glsl") ||
+       !program.link())
+    {
+        qDebug() << "Cannot build the impostor baking program.";
+        return false;
+    }
+
+    GLint attrVertex = program.attributeLocation("v_coord");
+    GLint attrNormal = program.attributeLocation("v_normal");
+    GLint attrColor = program.attributeLocation("v_color");
+
+    if(attrVertex < 0 || attrNormal < 0 || attrColor < 0)
+    {
+        qDebug() << "Cannot bind the attributes of the impostor baking program.";
+        return false;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // mesh
+    GLuint vertexArray;
+    GLuint buffers[2];
+
+    gl->glGenVertexArrays(1, &vertexArray);
+    gl->glBindVertexArray(vertexArray);
+    gl->glGenBuffers(2, buffers);
+
+    gl->glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    gl->glBufferData(GL_ARRAY_BUFFER, _mesh.getVertices().size() * sizeof(GLfloat),
+                     _mesh.getVertices().constData(), GL_STATIC_DRAW);
+
+    gl->glEnableVertexAttribArray(attrVertex);
+    gl->glVertexAttribPointer(attrVertex, 3, GL_FLOAT, GL_FALSE, TreeMesh::getStride(),
+                              (const void*)0);
+    gl->glEnableVertexAttribArray(attrNormal);
+    gl->glVertexAttribPointer(attrNormal, 3, GL_FLOAT, GL_FALSE, TreeMesh::getStride(),
+                              (const void*)(intptr_t)TreeMesh::getNormalOffset());
+    gl->glEnableVertexAttribArray(attrColor);
+    gl->glVertexAttribPointer(attrColor, 3, GL_FLOAT, GL_FALSE, TreeMesh::getStride(),
+                              (const void*)(intptr_t)TreeMesh::getColorOffset());
+
+    gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER, _mesh.getNumIndices() * sizeof(GLushort),
+                     _mesh.getIndices().constData(), GL_STATIC_DRAW);
+
+    /////////////////////////////////////////////////////////////////
+    // both layers are written by the same pass
+    GLuint framebuffer;
+    GLuint depthBuffer;
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+
+    gl->glGenFramebuffers(1, &framebuffer);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    gl->glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, texture->textureId(),
+                                  0, 0);
+    gl->glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, texture->textureId(),
+                                  0, 1);
+
+    gl->glGenRenderbuffers(1, &depthBuffer);
+    gl->glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    gl->glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, getAtlasSize(),
+                              getAtlasSize());
+    gl->glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                                  depthBuffer);
+    gl->glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    gl->glDrawBuffers(2, drawBuffers);
+
+    bool success = gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if(success)
+    {
+        // the transparent texels keep the foliage color and an upward normal,
+        // so filtering does not darken the edges
+        const GLfloat clearColor[] = {0.18f, 0.45f, 0.15f, 0.0f};
+        const GLfloat clearNormalDepth[] = {0.5f, 1.0f, 0.5f, 0.5f};
+        const GLfloat clearDepth = 1.0f;
+
+        gl->glViewport(0, 0, getAtlasSize(), getAtlasSize());
+        gl->glClearBufferfv(GL_COLOR, 0, clearColor);
+        gl->glClearBufferfv(GL_COLOR, 1, clearNormalDepth);
+        gl->glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+        GLboolean depthTest = gl->glIsEnabled(GL_DEPTH_TEST);
+        gl->glEnable(GL_DEPTH_TEST);
+
+        for(int i = 0; i < 4; ++i)
+        {
+            gl->glEnable(GL_CLIP_DISTANCE0 + i);
+        }
+
+        program.bind();
+        program.setUniformValue("gridSize", IMPOSTOR_GRID_SIZE);
+        gl->glDrawElementsInstanced(GL_TRIANGLES, _mesh.getNumIndices(), GL_UNSIGNED_SHORT, 0,
+                                    IMPOSTOR_GRID_SIZE * IMPOSTOR_GRID_SIZE);
+        program.release();
+
+        for(int i = 0; i < 4; ++i)
+        {
+            gl->glDisable(GL_CLIP_DISTANCE0 + i);
+        }
+
+        if(!depthTest)
+        {
+            gl->glDisable(GL_DEPTH_TEST);
+        }
+    }
+    else
+    {
+        qDebug() << "Impostor framebuffer is incomplete.";
+    }
+
+    /////////////////////////////////////////////////////////////////
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    gl->glDeleteRenderbuffers(1, &depthBuffer);
+    gl->glDeleteFramebuffers(1, &framebuffer);
+
+    gl->glBindVertexArray(0);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gl->glDeleteBuffers(2, buffers);
+    gl->glDeleteVertexArrays(1, &vertexArray);
+
+    return success;
+}
@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------------------
+// impostoratlas.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef IMPOSTORATLAS_H
+#define IMPOSTORATLAS_H
+
+#include <QOpenGLFunctions_4_0_Core>
+#include <QOpenGLTexture>
+
+#include "treemesh.h"
+
+#define IMPOSTOR_GRID_SIZE 8
+#define IMPOSTOR_CELL_SIZE 128
+// the coarsest level keeps a few texels per cell, lower levels would mix the views
+#define IMPOSTOR_MIP_LEVELS 5
+#define IMPOSTOR_CACHE_VERSION 1
+
+//------------------------------------------------------------------------------------------
+// Octahedral impostor of a mesh: IMPOSTOR_GRID_SIZE x IMPOSTOR_GRID_SIZE orthographic
+// views, the view directions of the grid cells cover the sphere through the octahedral
+// mapping. The atlas is a two-layer texture array, color and alpha in the first layer,
+// world normal and depth toward the viewer in the second.
+// All views are baked by a single instanced draw into both layers, the atlas is then
+// cached on disk next to the compressed textures and loaded at the next launch.
+//------------------------------------------------------------------------------------------
+class ImpostorAtlas
+{
+public:
+    ImpostorAtlas();
+    ~ImpostorAtlas();
+
+    // the baking renders into its own framebuffer, then binds back _framebuffer
+    bool create(QOpenGLFunctions_4_0_Core* _gl, const TreeMesh& _mesh, GLuint _framebuffer);
+
+    QOpenGLTexture* getTexture() const;
+    int getGridSize() const;
+    bool isLoadedFromCache() const;
+
+    static int getAtlasSize();
+    static QString getCachedFileName(const TreeMesh& _mesh);
+
+private:
+    void createTexture();
+    bool load(const QString& _fileName);
+    bool bake(const TreeMesh& _mesh, GLuint _framebuffer);
+    bool save(const QString& _fileName);
+
+    QOpenGLFunctions_4_0_Core* gl;
+    QOpenGLTexture* texture;
+    bool loadedFromCache;
+};
+
+#endif // IMPOSTORATLAS_H
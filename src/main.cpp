@@ -19,6 +19,10 @@ int main(int argc, char *argv[])
     QSurfaceFormat format;
     format.setVersion(4, 1);
     format.setSwapBehavior(QSurfaceFormat::DoubleBuffer);
+    // the continuous rendering mode is paced by vsync
+    format.setSwapInterval(1);
+    // multisampling is needed by the alpha-to-coverage billboard transparency
+    format.setSamples(4);
     format.setProfile(QSurfaceFormat::CoreProfile);
     QSurfaceFormat::setDefaultFormat(format);
 
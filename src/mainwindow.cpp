@@ -13,12 +13,6 @@ MainWindow::MainWindow(QWidget* parent) : QWidget(parent)
     setWindowTitle("Texture Billboard");
 
     setupGUI();
-
-
-    // Update continuously
-    QTimer* timer = new QTimer(this);
-    connect(timer, SIGNAL(timeout()), renderer, SLOT(update()));
-    timer->start(0);
 }
 
 //------------------------------------------------------------------------------------------
@@ -118,13 +112,142 @@ void MainWindow::setupGUI()
     connect(sldPlaneSize, &QSlider::valueChanged, renderer,
             &Renderer::changePlaneSize);
 
+    spbFloorSubdivisions = new QSpinBox;
+    spbFloorSubdivisions->setMinimum(1);
+    spbFloorSubdivisions->setMaximum(MAX_FLOOR_SUBDIVISIONS);
+    spbFloorSubdivisions->setValue(DEFAULT_FLOOR_SUBDIVISIONS);
+    spbFloorSubdivisions->setKeyboardTracking(false);
+
+    connect(spbFloorSubdivisions, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            renderer, &Renderer::changeFloorSubdivisions);
+
     QVBoxLayout* planeSizeLayout = new QVBoxLayout;
     planeSizeLayout->addWidget(sldPlaneSize);
+    planeSizeLayout->addWidget(new QLabel("Floor Subdivisions"));
+    planeSizeLayout->addWidget(spbFloorSubdivisions);
     QGroupBox* planeSizeGroup = new QGroupBox("Plane Size");
     planeSizeGroup->setLayout(planeSizeLayout);
 
 
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // number of billboards
+    spbNumBillboards = new QSpinBox;
+    spbNumBillboards->setMinimum(1);
+    spbNumBillboards->setMaximum(MAX_NUM_BILLBOARDS);
+    spbNumBillboards->setSingleStep(1000);
+    spbNumBillboards->setValue(DEFAULT_NUM_BILLBOARDS);
+    spbNumBillboards->setKeyboardTracking(false);
+
+    connect(spbNumBillboards, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            renderer, &Renderer::changeNumBillboards);
+
+    QVBoxLayout* numBillboardsLayout = new QVBoxLayout;
+    numBillboardsLayout->addWidget(spbNumBillboards);
+    QGroupBox* numBillboardsGroup = new QGroupBox("Number of Billboards");
+    numBillboardsGroup->setLayout(numBillboardsLayout);
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // billboard culling
+    cbBillboardCulling = new QComboBox;
+    cbBillboardCulling->addItem("No Culling", NO_CULLING);
+    cbBillboardCulling->addItem("CPU Frustum Culling", CPU_FRUSTUM_CULLING);
+    cbBillboardCulling->addItem("GPU Frustum Culling", GPU_FRUSTUM_CULLING);
+    cbBillboardCulling->setCurrentIndex(CPU_FRUSTUM_CULLING);
+
+    connect(cbBillboardCulling,
+            static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            renderer, &Renderer::changeBillboardCullingMode);
+
+    sldDrawDistance = new QSlider(Qt::Horizontal);
+    sldDrawDistance->setMinimum(10);
+    sldDrawDistance->setMaximum(1000);
+    sldDrawDistance->setValue((int)DEFAULT_BILLBOARD_DRAW_DISTANCE);
+
+    connect(sldDrawDistance, &QSlider::valueChanged, renderer,
+            &Renderer::changeBillboardDrawDistance);
+
+    chkEnableBillboardSorting = new QCheckBox("Sort Billboards Back to Front (CPU culling)");
+    chkEnableBillboardSorting->setChecked(true);
+    connect(chkEnableBillboardSorting, &QCheckBox::toggled, renderer,
+            &Renderer::enableBillboardSorting);
+
+    QVBoxLayout* billboardCullingLayout = new QVBoxLayout;
+    billboardCullingLayout->addWidget(cbBillboardCulling);
+    billboardCullingLayout->addWidget(new QLabel("Draw Distance"));
+    billboardCullingLayout->addWidget(sldDrawDistance);
+    billboardCullingLayout->addWidget(chkEnableBillboardSorting);
+    QGroupBox* billboardCullingGroup = new QGroupBox("Billboard Culling");
+    billboardCullingGroup->setLayout(billboardCullingLayout);
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // billboard transparency
+    cbBillboardTransparency = new QComboBox;
+    cbBillboardTransparency->addItem("Alpha Blending", ALPHA_BLENDING);
+    cbBillboardTransparency->addItem("Alpha Test", ALPHA_TEST);
+    cbBillboardTransparency->addItem("Alpha To Coverage (MSAA)", ALPHA_TO_COVERAGE);
+    cbBillboardTransparency->addItem("Hashed Alpha", HASHED_ALPHA);
+    cbBillboardTransparency->addItem("Weighted Blended OIT", WEIGHTED_BLENDED_OIT);
+    cbBillboardTransparency->setCurrentIndex(ALPHA_BLENDING);
+
+    connect(cbBillboardTransparency,
+            static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            renderer, &Renderer::changeBillboardTransparencyMode);
+
+    QVBoxLayout* billboardTransparencyLayout = new QVBoxLayout;
+    billboardTransparencyLayout->addWidget(cbBillboardTransparency);
+    QGroupBox* billboardTransparencyGroup = new QGroupBox("Billboard Transparency");
+    billboardTransparencyGroup->setLayout(billboardTransparencyLayout);
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // billboard level of detail
+    chkEnableMeshLOD = new QCheckBox("Tree Meshes Near the Camera (CPU culling)");
+    chkEnableMeshLOD->setChecked(false);
+    connect(chkEnableMeshLOD, &QCheckBox::toggled, renderer,
+            &Renderer::enableMeshLOD);
+
+    sldLODDistance = new QSlider(Qt::Horizontal);
+    sldLODDistance->setMinimum(5);
+    sldLODDistance->setMaximum(200);
+    sldLODDistance->setValue((int)DEFAULT_LOD_DISTANCE);
+
+    connect(sldLODDistance, &QSlider::valueChanged, renderer,
+            &Renderer::changeLODDistance);
+
+    QVBoxLayout* billboardLODLayout = new QVBoxLayout;
+    billboardLODLayout->addWidget(chkEnableMeshLOD);
+    billboardLODLayout->addWidget(new QLabel("Impostor Distance"));
+    billboardLODLayout->addWidget(sldLODDistance);
+    QGroupBox* billboardLODGroup = new QGroupBox("Billboard Level of Detail");
+    billboardLODGroup->setLayout(billboardLODLayout);
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // billboard wind
+    chkEnableWind = new QCheckBox("Enable Wind");
+    chkEnableWind->setChecked(false);
+    connect(chkEnableWind, &QCheckBox::toggled, renderer,
+            &Renderer::enableWind);
+
+    sldWindStrength = new QSlider(Qt::Horizontal);
+    sldWindStrength->setMinimum(0);
+    sldWindStrength->setMaximum(50);
+    sldWindStrength->setValue((int)(DEFAULT_WIND_STRENGTH * 100.0f));
+
+    connect(sldWindStrength, &QSlider::valueChanged, renderer,
+            &Renderer::changeWindStrength);
+
+    QVBoxLayout* billboardWindLayout = new QVBoxLayout;
+    billboardWindLayout->addWidget(chkEnableWind);
+    billboardWindLayout->addWidget(new QLabel("Wind Strength"));
+    billboardWindLayout->addWidget(sldWindStrength);
+    QGroupBox* billboardWindGroup = new QGroupBox("Billboard Wind");
+    billboardWindGroup->setLayout(billboardWindLayout);
+
+
     ////////////////////////////////////////////////////////////////////////////////
     // others
     chkEnableDepthTest = new QCheckBox("Enable Depth Test");
@@ -137,21 +260,88 @@ void MainWindow::setupGUI()
     connect(chkEnableZAxisRotation, &QCheckBox::toggled, renderer,
             &Renderer::enableZAxisRotation);
 
+    chkEnableSphericalBillboard = new QCheckBox("Spherical Billboard");
+    chkEnableSphericalBillboard->setChecked(false);
+    connect(chkEnableSphericalBillboard, &QCheckBox::toggled, renderer,
+            &Renderer::enableSphericalBillboard);
+
+    chkEnableWorldStreaming = new QCheckBox("Streamed World");
+    chkEnableWorldStreaming->setChecked(false);
+    connect(chkEnableWorldStreaming, &QCheckBox::toggled, renderer,
+            &Renderer::enableWorldStreaming);
+
+    chkEnableCompressedVertexFormat = new QCheckBox("Compressed Vertex Format");
+    chkEnableCompressedVertexFormat->setChecked(true);
+    connect(chkEnableCompressedVertexFormat, &QCheckBox::toggled, renderer,
+            &Renderer::enableCompressedVertexFormat);
+
+    chkEnableContinuousRendering = new QCheckBox("Continuous Rendering (VSync)");
+    chkEnableContinuousRendering->setChecked(false);
+    connect(chkEnableContinuousRendering, &QCheckBox::toggled, renderer,
+            &Renderer::enableContinuousRendering);
+
     QPushButton* btnResetCamera = new QPushButton("Reset Camera");
     connect(btnResetCamera, &QPushButton::clicked, renderer,
             &Renderer::resetCameraPosition);
 
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // frame statistics
+    lblFrameStatistics = new QLabel;
+
+    QVBoxLayout* frameStatisticsLayout = new QVBoxLayout;
+    frameStatisticsLayout->addWidget(lblFrameStatistics);
+    QGroupBox* frameStatisticsGroup = new QGroupBox("Frame Statistics");
+    frameStatisticsGroup->setLayout(frameStatisticsLayout);
+
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // frame profiler
+    lblFrameProfile = new QLabel;
+    lblFrameProfile->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    frameProfileTimer = new QTimer(this);
+    connect(frameProfileTimer, &QTimer::timeout, this,
+            &MainWindow::updateFrameProfile);
+    connect(frameProfileTimer, &QTimer::timeout, this,
+            &MainWindow::updateFrameStatistics);
+    frameProfileTimer->setInterval(FRAME_PROFILE_REFRESH_INTERVAL);
+    connect(renderer, &Renderer::renderingStarted, this,
+            &MainWindow::startFrameOverlayRefresh);
+    connect(renderer, &Renderer::renderingStopped, this,
+            &MainWindow::stopFrameOverlayRefresh);
+
+    QPushButton* btnExportFrameProfile = new QPushButton("Export Chrome Trace...");
+    connect(btnExportFrameProfile, &QPushButton::clicked, this,
+            &MainWindow::exportFrameProfile);
+
+    QVBoxLayout* frameProfileLayout = new QVBoxLayout;
+    frameProfileLayout->addWidget(lblFrameProfile);
+    frameProfileLayout->addWidget(btnExportFrameProfile);
+    QGroupBox* frameProfileGroup = new QGroupBox("Frame Profiler (CPU / GPU ms)");
+    frameProfileGroup->setLayout(frameProfileLayout);
+
+
     ////////////////////////////////////////////////////////////////////////////////
     // Add slider group to parameter group
     QVBoxLayout* parameterLayout = new QVBoxLayout;
     parameterLayout->addWidget(textureFilteringGroup);
     parameterLayout->addWidget(chkTextureAnisotropicFiltering);
     parameterLayout->addWidget(planeSizeGroup);
+    parameterLayout->addWidget(numBillboardsGroup);
+    parameterLayout->addWidget(billboardCullingGroup);
+    parameterLayout->addWidget(billboardTransparencyGroup);
+    parameterLayout->addWidget(billboardLODGroup);
+    parameterLayout->addWidget(billboardWindGroup);
     parameterLayout->addWidget(chkEnableDepthTest);
     parameterLayout->addWidget(chkEnableZAxisRotation);
+    parameterLayout->addWidget(chkEnableSphericalBillboard);
+    parameterLayout->addWidget(chkEnableWorldStreaming);
+    parameterLayout->addWidget(chkEnableCompressedVertexFormat);
+    parameterLayout->addWidget(chkEnableContinuousRendering);
 
     parameterLayout->addWidget(btnResetCamera);
+    parameterLayout->addWidget(frameStatisticsGroup);
+    parameterLayout->addWidget(frameProfileGroup);
 
 
 
@@ -179,3 +369,81 @@ void MainWindow::changeTextureFilteringMode()
         str2TextureFilteringMap[cbTextureFiltering->currentText()];
     renderer->changeFloorTextureFilteringMode(filterMode);
 }
+
+//------------------------------------------------------------------------------------------
+void MainWindow::updateFrameStatistics()
+{
+    const FrameStatistics& statistics = renderer->getFrameStatistics();
+    const char* sortResultStr[] = {"not sorted", "reused", "repaired", "radix"};
+
+    lblFrameStatistics->setText(QString("Visible billboards: %1 / %2\n"
+                                        "Cull time: %3 ms\n"
+                                        "Sort time: %4 ms (%5)\n"
+                                        "GL state calls: %6 issued, %7 skipped\n"
+                                        "World chunks: %8 resident, %9 KB\n"
+                                        "Tree meshes: %10")
+                                .arg(statistics.numVisibleBillboards)
+                                .arg(statistics.numBillboards)
+                                .arg(statistics.cullTime, 0, 'f', 3)
+                                .arg(statistics.sortTime, 0, 'f', 3)
+                                .arg(sortResultStr[statistics.sortResult])
+                                .arg(statistics.numIssuedGLCalls)
+                                .arg(statistics.numSkippedGLCalls)
+                                .arg(statistics.numResidentChunks)
+                                .arg(statistics.worldResidentBytes / 1024)
+                                .arg(statistics.numLODMeshes));
+}
+
+//------------------------------------------------------------------------------------------
+void MainWindow::updateFrameProfile()
+{
+    QStringList lines;
+
+    for(const ProfileScopeStatistics& scope : renderer->getFrameProfiler().getStatistics())
+    {
+        lines.append(QString("%1 %2 / %3")
+                     .arg(scope.name, -18)
+                     .arg(scope.cpuTime, 7, 'f', 3)
+                     .arg(scope.gpuTime, 7, 'f', 3));
+    }
+
+    lblFrameProfile->setText(lines.join("\n"));
+}
+
+//------------------------------------------------------------------------------------------
+// the overlays are refreshed by the timer only while frames are rendered,
+// the last frame is shown once the renderer goes idle
+//------------------------------------------------------------------------------------------
+void MainWindow::startFrameOverlayRefresh()
+{
+    if(!frameProfileTimer->isActive())
+    {
+        frameProfileTimer->start();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void MainWindow::stopFrameOverlayRefresh()
+{
+    frameProfileTimer->stop();
+    updateFrameStatistics();
+    updateFrameProfile();
+}
+
+//------------------------------------------------------------------------------------------
+void MainWindow::exportFrameProfile()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Chrome Trace",
+                                                    "trace.json", "Chrome Trace (*.json)");
+
+    if(fileName.isEmpty())
+    {
+        return;
+    }
+
+    if(!renderer->getFrameProfiler().exportChromeTrace(fileName))
+    {
+        QMessageBox::warning(this, "Export Chrome Trace",
+                             "Cannot write the trace to " + fileName);
+    }
+}
@@ -15,6 +15,11 @@
 
 #include "renderer.h"
 
+// while frames are rendered, the frame statistics and the profiler overlay are refreshed at
+// this interval instead of every frame, so that laying out the labels does not weigh on the
+// measured frames. The timer is stopped when the renderer goes idle.
+#define FRAME_PROFILE_REFRESH_INTERVAL 250
+
 class MainWindow : public QWidget
 {
     Q_OBJECT
@@ -32,6 +37,11 @@ protected:
 
 public slots:
     void changeTextureFilteringMode();
+    void updateFrameStatistics();
+    void updateFrameProfile();
+    void startFrameOverlayRefresh();
+    void stopFrameOverlayRefresh();
+    void exportFrameProfile();
 
 private:
 
@@ -45,7 +55,24 @@ private:
     QCheckBox* chkTextureAnisotropicFiltering;
     QCheckBox* chkEnableDepthTest;
     QCheckBox* chkEnableZAxisRotation;
+    QCheckBox* chkEnableSphericalBillboard;
+    QCheckBox* chkEnableWorldStreaming;
+    QCheckBox* chkEnableCompressedVertexFormat;
+    QCheckBox* chkEnableContinuousRendering;
+    QComboBox* cbBillboardCulling;
+    QSlider* sldDrawDistance;
+    QCheckBox* chkEnableBillboardSorting;
+    QComboBox* cbBillboardTransparency;
+    QCheckBox* chkEnableMeshLOD;
+    QSlider* sldLODDistance;
+    QCheckBox* chkEnableWind;
+    QSlider* sldWindStrength;
+    QLabel* lblFrameStatistics;
+    QLabel* lblFrameProfile;
+    QTimer* frameProfileTimer;
     QSlider* sldPlaneSize;
+    QSpinBox* spbNumBillboards;
+    QSpinBox* spbFloorSubdivisions;
 
 };
 
@@ -0,0 +1,182 @@
+//------------------------------------------------------------------------------------------
+// programcache.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+
+#include <cstring>
+
+#include "programcache.h"
+
+//------------------------------------------------------------------------------------------
+ProgramCache::ProgramCache():
+    gl(NULL)
+{
+}
+
+//------------------------------------------------------------------------------------------
+void ProgramCache::create(QOpenGLContext* _context)
+{
+    gl = _context->versionFunctions<QOpenGLFunctions_4_1_Core>();
+
+    if(!gl || !gl->initializeOpenGLFunctions())
+    {
+        gl = NULL;
+        return;
+    }
+
+    GLint numFormats = 0;
+    gl->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+    if(numFormats <= 0)
+    {
+        qDebug() << "The driver has no program binary format, the program cache is disabled.";
+        gl = NULL;
+        return;
+    }
+
+    driverId = QByteArray((const char*)gl->glGetString(GL_VENDOR)) + "|" +
+               QByteArray((const char*)gl->glGetString(GL_RENDERER)) + "|" +
+               QByteArray((const char*)gl->glGetString(GL_VERSION));
+}
+
+//------------------------------------------------------------------------------------------
+bool ProgramCache::isSupported() const
+{
+    return gl != NULL;
+}
+
+//------------------------------------------------------------------------------------------
+QByteArray ProgramCache::getKey(const QStringList& _sources) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QString("version=%1|").arg(PROGRAM_CACHE_VERSION).toUtf8());
+    hash.addData(driverId);
+
+    for(const QString& source : _sources)
+    {
+        hash.addData(source.toUtf8());
+        // separates the sources, so moving text between them changes the key
+        hash.addData("\0", 1);
+    }
+
+    return hash.result().toHex();
+}
+
+//------------------------------------------------------------------------------------------
+void ProgramCache::setRetrievable(QOpenGLShaderProgram* _program)
+{
+    if(gl)
+    {
+        _program->create();
+        gl->glProgramParameteri(_program->programId(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                GL_TRUE);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// the file holds the binary format followed by the binary.
+// Without attached shaders, QOpenGLShaderProgram::link() only queries the link status
+// set by glProgramBinary.
+//------------------------------------------------------------------------------------------
+bool ProgramCache::load(QOpenGLShaderProgram* _program, const QByteArray& _key)
+{
+    if(!gl)
+    {
+        return false;
+    }
+
+    QFile file(getCachedFileName(_key));
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+
+    if(data.size() <= (int)sizeof(GLenum))
+    {
+        return false;
+    }
+
+    GLenum format;
+    memcpy(&format, data.constData(), sizeof(GLenum));
+
+    _program->create();
+    gl->glProgramBinary(_program->programId(), format, data.constData() + sizeof(GLenum),
+                        data.size() - sizeof(GLenum));
+
+    GLint status = 0;
+    gl->glGetProgramiv(_program->programId(), GL_LINK_STATUS, &status);
+
+    if(!status)
+    {
+        qDebug() << "Program binary rejected by the driver:" << file.fileName();
+        return false;
+    }
+
+    return _program->link();
+}
+
+//------------------------------------------------------------------------------------------
+// written under a temporary name and renamed, as the texture cache files
+//------------------------------------------------------------------------------------------
+bool ProgramCache::save(QOpenGLShaderProgram* _program, const QByteArray& _key)
+{
+    if(!gl)
+    {
+        return false;
+    }
+
+    GLint length = 0;
+    gl->glGetProgramiv(_program->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if(length <= 0)
+    {
+        return false;
+    }
+
+    QByteArray data(sizeof(GLenum) + length, 0);
+    GLenum format = 0;
+    gl->glGetProgramBinary(_program->programId(), length, NULL, &format,
+                           data.data() + sizeof(GLenum));
+    memcpy(data.data(), &format, sizeof(GLenum));
+
+    QString fileName = getCachedFileName(_key);
+    QString tmpFileName = fileName + ".tmp";
+    QDir().mkpath(getCacheDirectory());
+
+    QFile file(tmpFileName);
+
+    if(!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+    {
+        qDebug() << "Cannot write program cache file:" << tmpFileName;
+        return false;
+    }
+
+    file.close();
+    QFile::remove(fileName);
+
+    return QFile::rename(tmpFileName, fileName);
+}
+
+//------------------------------------------------------------------------------------------
+QString ProgramCache::getCacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           "/TextureBillboard/programs";
+}
+
+//------------------------------------------------------------------------------------------
+QString ProgramCache::getCachedFileName(const QByteArray& _key) const
+{
+    return QString("%1/%2.bin").arg(getCacheDirectory()).arg(QString(_key));
+}
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------------------
+// programcache.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_4_1_Core>
+#include <QOpenGLShaderProgram>
+#include <QStringList>
+
+#define PROGRAM_CACHE_VERSION 1
+
+//------------------------------------------------------------------------------------------
+// On-disk cache of linked program binaries (glProgramBinary, OpenGL 4.1).
+// A binary is named after the hash of the program sources with their injected defines,
+// of the link setup and of the driver vendor, renderer and version: editing a shader or
+// updating the driver misses the cache. A binary rejected by the driver is a miss too,
+// the program is then compiled from its sources and the binary is written again.
+//------------------------------------------------------------------------------------------
+class ProgramCache
+{
+public:
+    ProgramCache();
+
+    // the cache is disabled on contexts without any program binary format
+    void create(QOpenGLContext* _context);
+    bool isSupported() const;
+
+    QByteArray getKey(const QStringList& _sources) const;
+
+    // must be called before linking a program to be saved
+    void setRetrievable(QOpenGLShaderProgram* _program);
+    bool load(QOpenGLShaderProgram* _program, const QByteArray& _key);
+    bool save(QOpenGLShaderProgram* _program, const QByteArray& _key);
+
+    static QString getCacheDirectory();
+
+private:
+    QString getCachedFileName(const QByteArray& _key) const;
+
+    QOpenGLFunctions_4_1_Core* gl;
+    QByteArray driverId;
+};
+
+#endif // PROGRAMCACHE_H
@@ -11,26 +11,68 @@
 //------------------------------------------------------------------------------------------
 Renderer::Renderer(QWidget* _parent):
     QOpenGLWidget(_parent),
-    enabledZAxisRotation(false),
-    enabledTextureAnisotropicFiltering(true),
+    numBillboardTextureLayers(1),
+    pendingBillboardTexture(NULL),
+    pendingBillboardLayersCompressed(false),
+    numUploadedBillboardLayers(0),
+    pboTextureUpload(QOpenGLBuffer::PixelUnpackBuffer),
+    enabledTextureCache(false),
+    planeObject(NULL),
+    floorSubdivisions(DEFAULT_FLOOR_SUBDIVISIONS),
+    enabledWorldStreaming(false),
+    numSceneBillboards(DEFAULT_NUM_BILLBOARDS),
+    vertexFormat(COMPRESSED_VERTICES),
+    planeTexCoordScale(1.0f),
+    numCachedPrograms(0),
+    numCompiledPrograms(0),
+    programStartupTime(0.0),
+    iboLODMesh(QOpenGLBuffer::IndexBuffer),
+    billboardCullingQueryPending(false),
+    vaoWorldChunkBuffer(0),
+    FBOTransparency(0),
+    transparencySamples(0),
+    transparencyFramebufferWidth(0),
+    transparencyFramebufferHeight(0),
+    transparencyDepthBlitChecked(false),
     iboPlane(QOpenGLBuffer::IndexBuffer),
     iboBillboard(QOpenGLBuffer::IndexBuffer),
-    specialKeyPressed(Renderer::NO_KEY),
-    mouseButtonPressed(Renderer::NO_BUTTON),
+    numDrawnBillboards(0),
+    numDrawnLODMeshes(0),
+    zooming(0.0f),
+    cameraPosition(DEFAULT_CAMERA_POSITION),
+    cameraFocus(DEFAULT_CAMERA_FOCUS),
+    cameraUpDirection(0.0f, 1.0f, 0.0f),
+    simulationTimeAccumulator(0.0),
+    simulationFrameTime(0.0),
+    simulationIdle(true),
     translation(0.0f, 0.0f, 0.0f),
     translationLag(0.0f, 0.0f, 0.0f),
     rotation(0.0f, 0.0f, 0.0f),
     rotationLag(0.0f, 0.0f, 0.0f),
-    zooming(0.0f),
-    planeObject(NULL),
+    specialKeyPressed(Renderer::NO_KEY),
+    mouseButtonPressed(Renderer::NO_BUTTON),
     shadingMode(PHONG_SHADING),
-    cameraPosition(DEFAULT_CAMERA_POSITION),
-    cameraFocus(DEFAULT_CAMERA_FOCUS),
-    cameraUpDirection(0.0f, 1.0f, 0.0f),
-    floorTexture(CHECKERBOARD)
+    floorTexture(CHECKERBOARD),
+    floorTextureFiltering(QOpenGLTexture::LinearMipMapLinear),
+    enabledZAxisRotation(false),
+    enabledTextureAnisotropicFiltering(true),
+    enabledSphericalBillboard(false),
+    billboardCullingMode(CPU_FRUSTUM_CULLING),
+    billboardDrawDistance(DEFAULT_BILLBOARD_DRAW_DISTANCE),
+    enabledBillboardSorting(true),
+    enabledContinuousRendering(false),
+    enabledMeshLOD(false),
+    lodDistance(DEFAULT_LOD_DISTANCE),
+    enabledWind(false),
+    windStrength(DEFAULT_WIND_STRENGTH),
+    windTime(0.0),
+    billboardTransparency(ALPHA_BLENDING)
 {
     retinaScale = devicePixelRatio();
     setFocusPolicy(Qt::StrongFocus);
+
+    setCameraState(DEFAULT_CAMERA_POSITION, DEFAULT_CAMERA_FOCUS,
+                   QVector3D(0.0f, 1.0f, 0.0f));
 }
 
 //------------------------------------------------------------------------------------------
@@ -59,38 +101,250 @@ void Renderer::checkOpenGLVersion()
 //    TRUE_OR_DIE(major >= 4 && minor >= 0, "OpenGL version must >= 4.0");
 }
 //------------------------------------------------------------------------------------------
-bool Renderer::initProgram(ShadingProgram _shadingMode)
+// the #include "file" lines are replaced by the file next to the shader,
+// the feature defines are inserted right after the #version line
+//------------------------------------------------------------------------------------------
+QString Renderer::loadShaderSource(const QString& _fileName, quint32 _features)
+{
+    QFile file(_fileName);
+    TRUE_OR_DIE(file.open(QIODevice::ReadOnly | QIODevice::Text),
+                "Cannot load shader from file.");
+    QString source = QString::fromUtf8(file.readAll());
+
+    QRegularExpression includeExpression("^#include \"([^\"]+)\"[^\n]*$",
+                                         QRegularExpression::MultilineOption);
+    QRegularExpressionMatch include;
+
+    while((include = includeExpression.match(source)).hasMatch())
+    {
+        QFile includeFile(QFileInfo(_fileName).path() + "/" + include.captured(1));
+        TRUE_OR_DIE(includeFile.open(QIODevice::ReadOnly | QIODevice::Text),
+                    "Cannot load shader include from file.");
+        source.replace(include.capturedStart(), include.capturedLength(),
+                       QString::fromUtf8(includeFile.readAll()));
+    }
+
+    QString defines;
+
+    if(_features & SHADER_OBJECT_TEXTURE)
+    {
+        defines += "#define OBJECT_TEXTURE\n";
+    }
+
+    if(_features & SHADER_MATERIAL_DIFFUSE)
+    {
+        defines += "#define MATERIAL_DIFFUSE\n";
+    }
+
+    if(_features & SHADER_REFLECTION)
+    {
+        defines += "#define REFLECTION\n";
+    }
+
+    if(_features & SHADER_MULTISAMPLE)
+    {
+        defines += "#define MULTISAMPLE\n";
+    }
+
+    if(_features & SHADER_ALPHA_TEST)
+    {
+        defines += "#define ALPHA_TEST\n";
+    }
+
+    if(_features & SHADER_ALPHA_TO_COVERAGE)
+    {
+        defines += "#define ALPHA_TO_COVERAGE\n";
+    }
+
+    if(_features & SHADER_HASHED_ALPHA)
+    {
+        defines += "#define HASHED_ALPHA\n";
+    }
+
+    if(_features & SHADER_WEIGHTED_BLENDED_OIT)
+    {
+        defines += "#define WEIGHTED_BLENDED_OIT\n";
+    }
+
+    if(_features & SHADER_OCTAHEDRAL_NORMAL)
+    {
+        defines += "#define OCTAHEDRAL_NORMAL\n";
+    }
+
+    source.insert(source.indexOf('\n', source.indexOf("#version")) + 1, defines);
+
+    return source;
+}
+
+//------------------------------------------------------------------------------------------
+// compile the variant of a program for a feature bitmask, or return it from the cache.
+// A variant not compiled yet in this session is first looked up in the program binary
+// cache, keyed by its sources and link setup.
+//------------------------------------------------------------------------------------------
+QOpenGLShaderProgram* Renderer::compileProgram(ShadingProgram _shadingMode, quint32 _features)
+{
+    quint32 key = ((quint32)_shadingMode << 16) | _features;
+
+    if(shaderVariants.contains(key))
+    {
+        return shaderVariants.value(key);
+    }
+
+    /////////////////////////////////////////////////////////////////
+    QString vertexSource = loadShaderSource(vertexShaderSourceMap.value(_shadingMode),
+                                            _features);
+    QString geometrySource, fragmentSource;
+
+    if(geometryShaderSourceMap.contains(_shadingMode))
+    {
+        geometrySource = loadShaderSource(geometryShaderSourceMap.value(_shadingMode),
+                                          _features);
+    }
+
+    // the culling program has no fragment stage
+    if(fragmentShaderSourceMap.contains(_shadingMode))
+    {
+        fragmentSource = loadShaderSource(fragmentShaderSourceMap.value(_shadingMode),
+                                          _features);
+    }
+
+    // all variants get the same attribute locations, so they share the vertex arrays
+    QStringList attributes;
+    attributes << "v_coord" << "v_normal" << "v_texcoord" << "v_color"
+               << "i_position" << "i_scale" << "i_tint" << "i_texLayer";
+
+    // same layout as BillboardInstance
+    const char* varyings[] = {"o_position", "o_scale", "o_tint", "o_texLayer"};
+    bool transformFeedback = (_shadingMode == BILLBOARD_CULLING);
+
+    QByteArray cacheKey = programCache.getKey(QStringList() << vertexSource << geometrySource
+                                              << fragmentSource << attributes.join(",")
+                                              << (transformFeedback ? "feedback" : ""));
+
+    /////////////////////////////////////////////////////////////////
+    QOpenGLShaderProgram* program = new QOpenGLShaderProgram;
+    bool loadedFromCache = programCache.load(program, cacheKey);
+
+    if(!loadedFromCache)
+    {
+        bool success;
+
+        success = program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource);
+        TRUE_OR_DIE(success, "Cannot compile shader from file.");
+
+        if(!geometrySource.isEmpty())
+        {
+            success = program->addShaderFromSourceCode(QOpenGLShader::Geometry, geometrySource);
+            TRUE_OR_DIE(success, "Cannot compile shader from file.");
+        }
+
+        if(!fragmentSource.isEmpty())
+        {
+            success = program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource);
+            TRUE_OR_DIE(success, "Cannot compile shader from file.");
+        }
+
+        for(int i = 0; i < attributes.size(); ++i)
+        {
+            program->bindAttributeLocation(attributes[i], i);
+        }
+
+        if(transformFeedback)
+        {
+            glTransformFeedbackVaryings(program->programId(), 4, varyings,
+                                        GL_INTERLEAVED_ATTRIBS);
+        }
+
+        programCache.setRetrievable(program);
+        success = program->link();
+        TRUE_OR_DIE(success, "Cannot link GLSL program.");
+
+        programCache.save(program, cacheKey);
+        ++numCompiledPrograms;
+    }
+    else
+    {
+        ++numCachedPrograms;
+    }
+
+    shaderVariants.insert(key, program);
+
+    return program;
+}
+
+//------------------------------------------------------------------------------------------
+// the attributes are looked up once, the first variant must use all of them
+//------------------------------------------------------------------------------------------
+bool Renderer::initProgram(ShadingProgram _shadingMode, quint32 _features)
 {
     QOpenGLShaderProgram* program;
     GLint location;
 
     /////////////////////////////////////////////////////////////////
-    glslPrograms[_shadingMode] = new QOpenGLShaderProgram;
+    glslPrograms[_shadingMode] = compileProgram(_shadingMode, _features);
+    programFeatures[_shadingMode] = _features;
     program = glslPrograms[_shadingMode];
-    bool success;
 
-    success = program->addShaderFromSourceFile(QOpenGLShader::Vertex,
-              vertexShaderSourceMap.value(_shadingMode));
-    TRUE_OR_DIE(success, "Cannot compile shader from file.");
+    // billboards expanded by the geometry shader have no per-vertex attributes
+    if(_shadingMode != BILLBOARD_EXPAND_SHADING)
+    {
+        location = program->attributeLocation("v_coord");
+        TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex coordinate.");
+        attrVertex[_shadingMode] = location;
 
-    success = program->addShaderFromSourceFile(QOpenGLShader::Fragment,
-              fragmentShaderSourceMap.value(_shadingMode));
-    TRUE_OR_DIE(success, "Cannot compile shader from file.");
+        location = program->attributeLocation("v_texcoord");
+        TRUE_OR_DIE(location >= 0, "Cannot bind attribute texture coordinate.");
+        attrTexCoord[_shadingMode] = location;
+    }
 
-    success = program->link();
-    TRUE_OR_DIE(success, "Cannot link GLSL program.");
+    // billboards compute their normal from the facing basis
+    if(_shadingMode == PHONG_SHADING)
+    {
+        location = program->attributeLocation("v_normal");
+        TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex normal.");
+        attrNormal[_shadingMode] = location;
+    }
+    else
+    {
+        initInstanceAttributes(_shadingMode);
+    }
 
-    location = program->attributeLocation("v_coord");
-    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex coordinate.");
-    attrVertex[_shadingMode] = location;
+    initProgramUniforms(_shadingMode);
 
-    location = program->attributeLocation("v_normal");
-    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex normal.");
-    attrNormal[_shadingMode] = location;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+// uniform locations differ between the variants, they are looked up at each switch.
+// The samplers only exist in the variants using them.
+//------------------------------------------------------------------------------------------
+void Renderer::initProgramUniforms(ShadingProgram _shadingMode)
+{
+    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
+    quint32 features = programFeatures[_shadingMode];
+    GLint location;
 
-    location = program->attributeLocation("v_texcoord");
-    TRUE_OR_DIE(location >= 0, "Cannot bind attribute texture coordinate.");
-    attrTexCoord[_shadingMode] = location;
+    if(_shadingMode == PHONG_SHADING)
+    {
+        location = program->uniformLocation("texCoordScale");
+        TRUE_OR_DIE(location >= 0, "Cannot bind uniform texCoordScale.");
+        uniTexCoordScale[_shadingMode] = location;
+    }
+    else
+    {
+        location = program->uniformLocation("sphericalBillboard");
+        TRUE_OR_DIE(location >= 0, "Cannot bind uniform sphericalBillboard.");
+        uniSphericalBillboard[_shadingMode] = location;
+
+        location = program->uniformLocation("drawDistance");
+        TRUE_OR_DIE(location >= 0 || !(features & SHADER_WEIGHTED_BLENDED_OIT),
+                    "Cannot bind uniform drawDistance.");
+        uniBillboardDrawDistance[_shadingMode] = location;
+
+        location = program->uniformLocation("wind");
+        TRUE_OR_DIE(location >= 0, "Cannot bind uniform wind.");
+        uniWind[_shadingMode] = location;
+    }
 
 
     location = glGetUniformBlockIndex(program->programId(), "Matrices");
@@ -112,18 +366,273 @@ bool Renderer::initProgram(ShadingProgram _shadingMode)
     uniCameraPosition[_shadingMode] = location;
 
     location = program->uniformLocation("envTex");
-    TRUE_OR_DIE(location >= 0, "Cannot bind uniform envTex.");
+    TRUE_OR_DIE(location >= 0 || !(features & SHADER_REFLECTION),
+                "Cannot bind uniform envTex.");
     uniEnvTexture[_shadingMode] = location;
 
 
     location = program->uniformLocation("objTex");
-    TRUE_OR_DIE(location >= 0, "Cannot bind uniform objTex.");
+    TRUE_OR_DIE(location >= 0 || !(features & SHADER_OBJECT_TEXTURE),
+                "Cannot bind uniform objTex.");
     uniObjTexture[_shadingMode] = location;
+}
+
+//------------------------------------------------------------------------------------------
+// switch a program to the variant of the given features, compiled on its first use.
+// The uniforms of the billboard programs not set per draw are restored on the new variant.
+//------------------------------------------------------------------------------------------
+void Renderer::selectProgramVariant(ShadingProgram _shadingMode, quint32 _features)
+{
+    if(programFeatures[_shadingMode] == _features)
+    {
+        return;
+    }
+
+    glslPrograms[_shadingMode] = compileProgram(_shadingMode, _features);
+    programFeatures[_shadingMode] = _features;
+    initProgramUniforms(_shadingMode);
+
+    if(_shadingMode == shadingMode)
+    {
+        currentProgram = glslPrograms[_shadingMode];
+    }
+
+    if(_shadingMode != PHONG_SHADING)
+    {
+        setSphericalBillboardUniform();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// a negative diffuse color selects the vertex color (the texture color for billboards),
+// the normal decoding of the current vertex format is compiled in
+//------------------------------------------------------------------------------------------
+quint32 Renderer::getMaterialFeatures(const Material& _material, bool _textured) const
+{
+    quint32 features = _textured ? SHADER_OBJECT_TEXTURE : 0;
+
+    if(vertexFormat.hasOctahedralNormals())
+    {
+        features |= SHADER_OCTAHEDRAL_NORMAL;
+    }
+
+    if(_material.diffuseColor.x() > -0.001f)
+    {
+        features |= SHADER_MATERIAL_DIFFUSE;
+    }
+
+    if(_material.reflection > 0.0f)
+    {
+        features |= SHADER_REFLECTION;
+    }
+
+    return features;
+}
+
+//------------------------------------------------------------------------------------------
+// the billboards are textured, their transparency mode is compiled in
+//------------------------------------------------------------------------------------------
+quint32 Renderer::getBillboardFeatures() const
+{
+    quint32 features = getMaterialFeatures(billboardObjectMaterial, true);
+
+    switch(billboardTransparency)
+    {
+    case ALPHA_TEST:
+        return features | SHADER_ALPHA_TEST;
+
+    case ALPHA_TO_COVERAGE:
+        return features | SHADER_ALPHA_TO_COVERAGE;
+
+    case HASHED_ALPHA:
+        return features | SHADER_HASHED_ALPHA;
+
+    case WEIGHTED_BLENDED_OIT:
+        return features | SHADER_WEIGHTED_BLENDED_OIT;
+
+    default:
+        return features;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::initInstanceAttributes(ShadingProgram _shadingMode)
+{
+    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
+    GLint location;
+
+    location = program->attributeLocation("i_position");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute instance position.");
+    attrInstancePosition[_shadingMode] = location;
+
+    location = program->attributeLocation("i_scale");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute instance scale.");
+    attrInstanceScale[_shadingMode] = location;
+
+    location = program->attributeLocation("i_tint");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute instance tint.");
+    attrInstanceTint[_shadingMode] = location;
+
+    // the texture layer may be optimized out while only one billboard texture exists
+    attrInstanceTextureLayer[_shadingMode] = program->attributeLocation("i_texLayer");
+}
+
+//------------------------------------------------------------------------------------------
+// the culling program only runs the vertex and geometry stages,
+// the surviving instances are captured by transform feedback
+//------------------------------------------------------------------------------------------
+bool Renderer::initCullingProgram()
+{
+    QOpenGLShaderProgram* program;
+    GLint location;
+
+    /////////////////////////////////////////////////////////////////
+    glslPrograms[BILLBOARD_CULLING] = compileProgram(BILLBOARD_CULLING, 0);
+    program = glslPrograms[BILLBOARD_CULLING];
+
+    initInstanceAttributes(BILLBOARD_CULLING);
+
+    location = program->uniformLocation("frustumPlanes");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform frustumPlanes.");
+    uniFrustumPlanes = location;
+
+    location = program->uniformLocation("cameraPosition");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform cameraPosition.");
+    uniCameraPosition[BILLBOARD_CULLING] = location;
+
+    location = program->uniformLocation("drawDistance");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform drawDistance.");
+    uniDrawDistance = location;
+
+    location = program->uniformLocation("swayExtent");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform swayExtent.");
+    uniSwayExtent = location;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+bool Renderer::initCompositeProgram()
+{
+    QOpenGLShaderProgram* program;
+    GLint location;
+
+    /////////////////////////////////////////////////////////////////
+    // the widget framebuffer is bound during the initialization
+    glGetIntegerv(GL_SAMPLES, &transparencySamples);
+
+    glslPrograms[OIT_COMPOSITE] = compileProgram(OIT_COMPOSITE,
+                                                 transparencySamples > 0 ? SHADER_MULTISAMPLE : 0);
+    program = glslPrograms[OIT_COMPOSITE];
+
+    location = program->uniformLocation("accumTex");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform accumTex.");
+    uniAccumTexture = location;
+
+    location = program->uniformLocation("revealageTex");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform revealageTex.");
+    uniRevealageTexture = location;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+// the tree meshes are lit without material nor texture,
+// their instances have the billboard layout
+//------------------------------------------------------------------------------------------
+bool Renderer::initLODMeshProgram()
+{
+    QOpenGLShaderProgram* program;
+    GLint location;
+
+    /////////////////////////////////////////////////////////////////
+    glslPrograms[LOD_MESH_SHADING] = compileProgram(LOD_MESH_SHADING, 0);
+    program = glslPrograms[LOD_MESH_SHADING];
+
+    location = program->attributeLocation("v_coord");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex coordinate.");
+    attrVertex[LOD_MESH_SHADING] = location;
+
+    location = program->attributeLocation("v_normal");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex normal.");
+    attrNormal[LOD_MESH_SHADING] = location;
+
+    location = program->attributeLocation("v_color");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex color.");
+    attrMeshColor = location;
+
+    initInstanceAttributes(LOD_MESH_SHADING);
+
+    location = glGetUniformBlockIndex(program->programId(), "Matrices");
+    TRUE_OR_DIE(location >= 0, "Cannot bind block uniform.");
+    uniMatrices[LOD_MESH_SHADING] = location;
+
+    location = glGetUniformBlockIndex(program->programId(), "Light");
+    TRUE_OR_DIE(location >= 0, "Cannot bind block uniform.");
+    uniLight[LOD_MESH_SHADING] = location;
+
+    location = program->uniformLocation("cameraPosition");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform cameraPosition.");
+    uniCameraPosition[LOD_MESH_SHADING] = location;
+
+    location = program->uniformLocation("lodDistance");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform lodDistance.");
+    uniLODDistance[LOD_MESH_SHADING] = location;
+
+    location = program->uniformLocation("lodFadeRange");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform lodFadeRange.");
+    uniLODFadeRange[LOD_MESH_SHADING] = location;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+// the impostors are placed like the billboards, their texture coordinates in the atlas
+// are derived from the quad position
+//------------------------------------------------------------------------------------------
+bool Renderer::initImpostorProgram()
+{
+    QOpenGLShaderProgram* program;
+    GLint location;
+
+    /////////////////////////////////////////////////////////////////
+    glslPrograms[IMPOSTOR_SHADING] = compileProgram(IMPOSTOR_SHADING, 0);
+    program = glslPrograms[IMPOSTOR_SHADING];
+
+    location = program->attributeLocation("v_coord");
+    TRUE_OR_DIE(location >= 0, "Cannot bind attribute vertex coordinate.");
+    attrVertex[IMPOSTOR_SHADING] = location;
+    attrTexCoord[IMPOSTOR_SHADING] = -1;
+
+    initInstanceAttributes(IMPOSTOR_SHADING);
+
+    location = glGetUniformBlockIndex(program->programId(), "Matrices");
+    TRUE_OR_DIE(location >= 0, "Cannot bind block uniform.");
+    uniMatrices[IMPOSTOR_SHADING] = location;
+
+    location = glGetUniformBlockIndex(program->programId(), "Light");
+    TRUE_OR_DIE(location >= 0, "Cannot bind block uniform.");
+    uniLight[IMPOSTOR_SHADING] = location;
+
+    location = program->uniformLocation("cameraPosition");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform cameraPosition.");
+    uniCameraPosition[IMPOSTOR_SHADING] = location;
+
+    location = program->uniformLocation("lodDistance");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform lodDistance.");
+    uniLODDistance[IMPOSTOR_SHADING] = location;
 
+    location = program->uniformLocation("lodFadeRange");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform lodFadeRange.");
+    uniLODFadeRange[IMPOSTOR_SHADING] = location;
 
-    location = program->uniformLocation("hasObjTex");
-    TRUE_OR_DIE(location >= 0, "Cannot bind uniform hasObjTex.");
-    uniHasObjTexture[_shadingMode] = location;
+    location = program->uniformLocation("gridSize");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform gridSize.");
+    uniImpostorGridSize = location;
+
+    location = program->uniformLocation("impostorTex");
+    TRUE_OR_DIE(location >= 0, "Cannot bind uniform impostorTex.");
+    uniImpostorTexture = location;
 
     return true;
 }
@@ -132,11 +641,36 @@ bool Renderer::initProgram(ShadingProgram _shadingMode)
 bool Renderer::initShaderPrograms()
 {
     vertexShaderSourceMap.insert(PHONG_SHADING, ":/shaders/phong-shading.vs.glsl");
+    vertexShaderSourceMap.insert(BILLBOARD_SHADING, ":/shaders/billboard.vs.glsl");
+    vertexShaderSourceMap.insert(BILLBOARD_CULLING, ":/shaders/billboard-culling.vs.glsl");
+    vertexShaderSourceMap.insert(BILLBOARD_EXPAND_SHADING,
+                                 ":/shaders/billboard-culling.vs.glsl");
 
-    fragmentShaderSourceMap.insert(PHONG_SHADING, ":/shaders/phong-shading.fs.glsl");
-
+    geometryShaderSourceMap.insert(BILLBOARD_CULLING, ":/shaders/billboard-culling.gs.glsl");
+    geometryShaderSourceMap.insert(BILLBOARD_EXPAND_SHADING,
+                                   ":/shaders/billboard-expand.gs.glsl");
 
-    return initProgram(PHONG_SHADING);
+    fragmentShaderSourceMap.insert(PHONG_SHADING, ":/shaders/phong-shading.fs.glsl");
+    fragmentShaderSourceMap.insert(BILLBOARD_SHADING, ":/shaders/billboard.fs.glsl");
+    fragmentShaderSourceMap.insert(BILLBOARD_EXPAND_SHADING, ":/shaders/billboard.fs.glsl");
+
+    vertexShaderSourceMap.insert(OIT_COMPOSITE, ":/shaders/oit-composite.vs.glsl");
+    fragmentShaderSourceMap.insert(OIT_COMPOSITE, ":/shaders/oit-composite.fs.glsl");
+
+    vertexShaderSourceMap.insert(LOD_MESH_SHADING, ":/shaders/lod-mesh.vs.glsl");
+    fragmentShaderSourceMap.insert(LOD_MESH_SHADING, ":/shaders/lod-mesh.fs.glsl");
+
+    vertexShaderSourceMap.insert(IMPOSTOR_SHADING, ":/shaders/octahedral-impostor.vs.glsl");
+    fragmentShaderSourceMap.insert(IMPOSTOR_SHADING, ":/shaders/octahedral-impostor.fs.glsl");
+
+    // only the variants of the current materials are compiled here, the others on demand
+    return initProgram(PHONG_SHADING, getMaterialFeatures(planeMaterial, true)) &&
+           initProgram(BILLBOARD_SHADING, getBillboardFeatures()) &&
+           initProgram(BILLBOARD_EXPAND_SHADING, getBillboardFeatures()) &&
+           initCullingProgram() &&
+           initCompositeProgram() &&
+           initLODMeshProgram() &&
+           initImpostorProgram();
 }
 
 //------------------------------------------------------------------------------------------
@@ -171,11 +705,9 @@ void Renderer::initSharedBlockUniform()
 
     /////////////////////////////////////////////////////////////////
     // setup data for block uniform
-    glGenBuffers(1, &UBOMatrices);
-    glBindBuffer(GL_UNIFORM_BUFFER, UBOMatrices);
-    glBufferData(GL_UNIFORM_BUFFER, 3 * SIZE_OF_MAT4, NULL,
-                 GL_STREAM_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // the matrices change per draw, they are streamed through the uniform ring buffer
+    uniformRingBuffer.create(this, 3 * SIZE_OF_MAT4, UNIFORM_RING_BLOCKS_PER_FRAME,
+                             UNIFORM_RING_NUM_FRAMES);
 
     glGenBuffers(1, &UBOLight);
     glBindBuffer(GL_UNIFORM_BUFFER, UBOLight);
@@ -204,10 +736,13 @@ void Renderer::initSharedBlockUniform()
 //------------------------------------------------------------------------------------------
 void Renderer::initTexture()
 {
+    maxTextureAnisotropy = 1.0f;
+
     if(QOpenGLContext::currentContext()->hasExtension("GL_EXT_texture_filter_anisotropic"))
     {
         qDebug() << "GL_EXT_texture_filter_anisotropic: enabled";
         glEnable(GL_EXT_texture_filter_anisotropic);
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxTextureAnisotropy);
     }
     else
     {
@@ -215,8 +750,13 @@ void Renderer::initTexture()
         glDisable(GL_EXT_texture_filter_anisotropic);
     }
 
+    // S3TC is not core, without it the textures are decoded at every launch
+    enabledTextureCache =
+        QOpenGLContext::currentContext()->hasExtension("GL_EXT_texture_compression_s3tc");
+    qDebug() << "Compressed texture cache:" << (enabledTextureCache ? "enabled" : "disabled");
+
     ////////////////////////////////////////////////////////////////////////////////
-    // floor texture
+    // floor texture, a flat placeholder is shown until the image is decoded
     QMap<FloorTexture, QString> floorTexture2StrMap;
     floorTexture2StrMap[CHECKERBOARD] = "checkerboard.jpg";
 
@@ -229,23 +769,334 @@ void Renderer::initTexture()
 
         QString texFile = QString(":/textures/%1").arg(floorTexture2StrMap[tex]);
         TRUE_OR_DIE(QFile::exists(texFile), "Cannot load texture from file.");
-        floorTextures[tex] = new QOpenGLTexture(QImage(texFile).mirrored());
-        floorTextures[tex]->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
-        floorTextures[tex]->setMagnificationFilter(QOpenGLTexture::LinearMipMapLinear);
+        floorTextureRequests[tex] = textureLoader.requestTexture(texFile, true,
+                                                                 enabledTextureCache);
+
+        QImage placeholder(1, 1, QImage::Format_RGBA8888);
+        placeholder.fill(QColor(128, 128, 128));
+        floorTextures[tex] = new QOpenGLTexture(placeholder);
         floorTextures[tex]->setWrapMode(QOpenGLTexture::Repeat);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
     // billboard texture
-    billboardTexture = new QOpenGLTexture(
-        QImage(":/textures/billboardblueflowers.png").convertToFormat(QImage::Format_RGBA8888));
-    billboardTexture->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
-    billboardTexture->setMagnificationFilter(QOpenGLTexture::LinearMipMapLinear);
-    billboardTexture->setWrapMode(QOpenGLTexture::DirectionS,
-                                  QOpenGLTexture::ClampToEdge);
-    billboardTexture->setWrapMode(QOpenGLTexture::DirectionT,
-                                  QOpenGLTexture::ClampToEdge);
+    initBillboardTextureArray();
+}
+
+//------------------------------------------------------------------------------------------
+// every PNG image in the billboard texture directory becomes one layer of a texture array,
+// so billboards of different species are drawn by the same instanced draw call.
+// The layers are decoded in the background, meanwhile a transparent array is bound.
+//------------------------------------------------------------------------------------------
+void Renderer::initBillboardTextureArray()
+{
+    QDir textureDir(":/textures/billboards", "*.png", QDir::Name, QDir::Files);
+    QStringList textureFiles = textureDir.entryList();
+    TRUE_OR_DIE(!textureFiles.isEmpty(), "Cannot find any billboard texture.");
+
+    for(const QString& textureFile : textureFiles)
+    {
+        billboardTextureRequests.append(textureLoader.requestTexture(
+                                            textureDir.filePath(textureFile), false,
+                                            enabledTextureCache));
+    }
+
+    numBillboardTextureLayers = textureFiles.size();
+    qDebug() << "Billboard texture layers: " << numBillboardTextureLayers;
+
+    QVector<GLuint> transparentTexels(numBillboardTextureLayers, 0);
+    billboardTexture = new QOpenGLTexture(QOpenGLTexture::Target2DArray);
+    billboardTexture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    billboardTexture->setSize(1, 1);
+    billboardTexture->setLayers(numBillboardTextureLayers);
+    billboardTexture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+
+    for(int layer = 0; layer < numBillboardTextureLayers; ++layer)
+    {
+        billboardTexture->setData(0, layer, QOpenGLTexture::RGBA, QOpenGLTexture::UInt8,
+                                  &transparentTexels[layer]);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// Replace the placeholders by the loaded textures, at most a few textures per frame.
+// Compressed textures are uploaded with their mip chain straight from the mapped cache file.
+// Decoded images go through a pixel buffer object, so the copy into the texture
+// is done by the driver without blocking on the application memory.
+//------------------------------------------------------------------------------------------
+void Renderer::uploadDecodedTextures()
+{
+    int numUploads = 0;
+
+    for(int i = 0; i < NUM_FLOOR_TEXTURES; ++i)
+    {
+        if(floorTextureRequests[i] < 0 || !textureLoader.isReady(floorTextureRequests[i]) ||
+           numUploads >= MAX_TEXTURE_UPLOADS_PER_FRAME)
+        {
+            continue;
+        }
+
+        LoadedTexture loaded = textureLoader.takeTexture(floorTextureRequests[i]);
+        floorTextureRequests[i] = -1;
+        QOpenGLTexture* texture;
+
+        if(loaded.compressed)
+        {
+            texture = createCompressedTexture(QOpenGLTexture::Target2D, *loaded.compressed, 1);
+            uploadCompressedLayer(texture, 0, *loaded.compressed);
+        }
+        else
+        {
+            TRUE_OR_DIE(!loaded.image.isNull(), "Cannot load texture from file.");
+            texture = createMipmappedTexture(QOpenGLTexture::Target2D, loaded.image.size(), 1);
+            uploadTextureLayer(texture, 0, loaded.image);
+            texture->generateMipMaps();
+        }
+
+        texture->setMinMagFilters(floorTextureFiltering, floorTextureFiltering);
+        texture->setWrapMode(QOpenGLTexture::Repeat);
+
+        delete floorTextures[i];
+        floorTextures[i] = texture;
+        ++numUploads;
+    }
+
+    // the texture objects were created and bound behind the state cache
+    if(numUploads > 0)
+    {
+        stateCache.invalidate();
+    }
+
+    uploadBillboardLayers(MAX_TEXTURE_UPLOADS_PER_FRAME - numUploads);
+}
+
+//------------------------------------------------------------------------------------------
+// The billboard layers share one texture: its format is chosen once all of them are loaded,
+// then at most _maxUploads layers are uploaded per frame, the placeholder stays bound
+// until the last one.
+//------------------------------------------------------------------------------------------
+void Renderer::uploadBillboardLayers(int _maxUploads)
+{
+    if(!billboardTextureRequests.isEmpty())
+    {
+        for(int request : billboardTextureRequests)
+        {
+            if(!textureLoader.isReady(request))
+            {
+                return;
+            }
+        }
+
+        pendingBillboardLayers.clear();
+        pendingBillboardLayersCompressed = true;
+
+        for(int request : billboardTextureRequests)
+        {
+            pendingBillboardLayers.append(textureLoader.takeTexture(request));
+
+            const QSharedPointer<CompressedTexture>& compressed =
+                pendingBillboardLayers.last().compressed;
+            const QSharedPointer<CompressedTexture>& first = pendingBillboardLayers[0].compressed;
+
+            if(!compressed || !first ||
+               compressed->getInternalFormat() != first->getInternalFormat() ||
+               compressed->getWidth() != first->getWidth() ||
+               compressed->getHeight() != first->getHeight() ||
+               compressed->getNumMipLevels() != first->getNumMipLevels())
+            {
+                pendingBillboardLayersCompressed = false;
+            }
+        }
+
+        billboardTextureRequests.clear();
+        numUploadedBillboardLayers = 0;
+        delete pendingBillboardTexture;
+        pendingBillboardTexture = NULL;
+    }
+
+    if(pendingBillboardLayers.isEmpty() || _maxUploads <= 0)
+    {
+        return;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    int lastLayer = qMin(numUploadedBillboardLayers + _maxUploads, numBillboardTextureLayers);
+
+    for(int layer = numUploadedBillboardLayers; layer < lastLayer; ++layer)
+    {
+        const LoadedTexture& loaded = pendingBillboardLayers[layer];
+
+        if(pendingBillboardLayersCompressed)
+        {
+            if(!pendingBillboardTexture)
+            {
+                pendingBillboardTexture = createCompressedTexture(QOpenGLTexture::Target2DArray,
+                                                                  *loaded.compressed,
+                                                                  numBillboardTextureLayers);
+            }
+
+            uploadCompressedLayer(pendingBillboardTexture, layer, *loaded.compressed);
+            continue;
+        }
+
+        // layers which cannot share the compressed format are decoded again
+        QImage image = loaded.image.isNull() ?
+                       TextureLoader::decodeImage(loaded.fileName, loaded.mirrored) :
+                       loaded.image;
+        TRUE_OR_DIE(!image.isNull(), "Cannot load texture from file.");
+
+        // the layers take the size of the first image, the others are rescaled to fit
+        if(!pendingBillboardTexture)
+        {
+            pendingBillboardTexture = createMipmappedTexture(QOpenGLTexture::Target2DArray,
+                                                             image.size(),
+                                                             numBillboardTextureLayers);
+        }
+        else if(image.width() != pendingBillboardTexture->width() ||
+                image.height() != pendingBillboardTexture->height())
+        {
+            image = image.scaled(pendingBillboardTexture->width(),
+                                 pendingBillboardTexture->height(),
+                                 Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+
+        uploadTextureLayer(pendingBillboardTexture, layer, image);
+    }
+
+    numUploadedBillboardLayers = lastLayer;
+    stateCache.invalidate();
+
+    if(numUploadedBillboardLayers < numBillboardTextureLayers)
+    {
+        return;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    QOpenGLTexture* texture = pendingBillboardTexture;
+
+    if(!pendingBillboardLayersCompressed)
+    {
+        texture->generateMipMaps();
+    }
+
+    texture->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
+    texture->setMagnificationFilter(QOpenGLTexture::Linear);
+    texture->setWrapMode(QOpenGLTexture::DirectionS, QOpenGLTexture::ClampToEdge);
+    texture->setWrapMode(QOpenGLTexture::DirectionT, QOpenGLTexture::ClampToEdge);
+
+    delete billboardTexture;
+    billboardTexture = texture;
+    pendingBillboardTexture = NULL;
+    pendingBillboardLayers.clear();
+    stateCache.invalidate();
+}
+
+//------------------------------------------------------------------------------------------
+QOpenGLTexture* Renderer::createCompressedTexture(QOpenGLTexture::Target _target,
+                                                  const CompressedTexture& _compressed,
+                                                  int _numLayers)
+{
+    QOpenGLTexture* texture = new QOpenGLTexture(_target);
+    texture->setFormat(static_cast<QOpenGLTexture::TextureFormat>
+                       (_compressed.getInternalFormat()));
+    texture->setSize(_compressed.getWidth(), _compressed.getHeight());
+
+    if(_target == QOpenGLTexture::Target2DArray)
+    {
+        texture->setLayers(_numLayers);
+    }
+
+    texture->setMipLevels(_compressed.getNumMipLevels());
+    texture->allocateStorage();
+
+    return texture;
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::uploadCompressedLayer(QOpenGLTexture* _texture, int _layer,
+                                     const CompressedTexture& _compressed)
+{
+    _texture->bind();
+
+    for(int level = 0; level < _compressed.getNumMipLevels(); ++level)
+    {
+        int levelWidth = qMax(1, _compressed.getWidth() >> level);
+        int levelHeight = qMax(1, _compressed.getHeight() >> level);
+
+        if(_texture->target() == QOpenGLTexture::Target2DArray)
+        {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, _layer,
+                                      levelWidth, levelHeight, 1,
+                                      _compressed.getInternalFormat(),
+                                      _compressed.getMipLevelDataSize(level),
+                                      _compressed.getMipLevelData(level));
+        }
+        else
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, levelWidth, levelHeight,
+                                      _compressed.getInternalFormat(),
+                                      _compressed.getMipLevelDataSize(level),
+                                      _compressed.getMipLevelData(level));
+        }
+    }
+
+    _texture->release();
+}
+
+//------------------------------------------------------------------------------------------
+QOpenGLTexture* Renderer::createMipmappedTexture(QOpenGLTexture::Target _target,
+                                                 const QSize& _size, int _numLayers)
+{
+    QOpenGLTexture* texture = new QOpenGLTexture(_target);
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setSize(_size.width(), _size.height());
+
+    if(_target == QOpenGLTexture::Target2DArray)
+    {
+        texture->setLayers(_numLayers);
+    }
 
+    texture->setMipLevels(texture->maximumMipLevels());
+    texture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+
+    return texture;
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::uploadTextureLayer(QOpenGLTexture* _texture, int _layer, const QImage& _image)
+{
+    const int dataSize = (int)_image.sizeInBytes();
+
+    if(!pboTextureUpload.isCreated())
+    {
+        pboTextureUpload.create();
+        pboTextureUpload.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    }
+
+    // reallocating the storage orphans the previous upload, which may still be in flight
+    pboTextureUpload.bind();
+    pboTextureUpload.allocate(dataSize);
+    void* pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, dataSize,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    TRUE_OR_DIE(pixels != NULL, "Cannot map the texture upload buffer.");
+    memcpy(pixels, _image.constBits(), dataSize);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    _texture->bind();
+
+    if(_texture->target() == QOpenGLTexture::Target2DArray)
+    {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, _layer, _image.width(), _image.height(), 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _image.width(), _image.height(),
+                        GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    }
+
+    _texture->release();
+    pboTextureUpload.release();
 }
 
 //------------------------------------------------------------------------------------------
@@ -253,6 +1104,9 @@ void Renderer::initSceneMemory()
 {
     initPlaneMemory();
     initBillboardMemory();
+    initBillboardInstanceMemory();
+    initBillboardCullingMemory();
+    initLODMeshMemory();
 }
 
 //------------------------------------------------------------------------------------------
@@ -275,20 +1129,17 @@ void Renderer::initPlaneMemory()
 
     ////////////////////////////////////////////////////////////////////////////////
     // init memory for plane object
+    // the floor is a tessellated grid, the unit plane remains the billboard quad
+    floorMesh.generate(floorSubdivisions, floorSubdivisions, vertexFormat);
+
     vboPlane.create();
     vboPlane.bind();
-    vboPlane.allocate(2 * planeObject->getVertexOffset() + planeObject->getTexCoordOffset());
-    vboPlane.write(0, planeObject->getVertices(), planeObject->getVertexOffset());
-    vboPlane.write(planeObject->getVertexOffset(), planeObject->getNormals(),
-                   planeObject->getVertexOffset());
-    vboPlane.write(2 * planeObject->getVertexOffset(),
-                   planeObject->getTexureCoordinates(1.0f),
-                   planeObject->getTexCoordOffset());
+    vboPlane.allocate(floorMesh.getVertices().constData(), floorMesh.getVertices().size());
     vboPlane.release();
     // indices
     iboPlane.create();
     iboPlane.bind();
-    iboPlane.allocate(planeObject->getIndices(), planeObject->getIndexOffset());
+    iboPlane.allocate(floorMesh.getIndices().constData(), floorMesh.getIndices().size());
     iboPlane.release();
 
 }
@@ -313,16 +1164,11 @@ void Renderer::initBillboardMemory()
 
     ////////////////////////////////////////////////////////////////////////////////
     // init memory for billboard object
+    QByteArray vertices = planeObject->getInterleavedVertices(vertexFormat);
+
     vboBillboard.create();
     vboBillboard.bind();
-    vboBillboard.allocate(2 * planeObject->getVertexOffset() +
-                          planeObject->getTexCoordOffset());
-    vboBillboard.write(0, planeObject->getVertices(), planeObject->getVertexOffset());
-    vboBillboard.write(planeObject->getVertexOffset(), planeObject->getNormals(),
-                       planeObject->getVertexOffset());
-    vboBillboard.write(2 * planeObject->getVertexOffset(),
-                       planeObject->getTexureCoordinates(1.0f),
-                       planeObject->getTexCoordOffset());
+    vboBillboard.allocate(vertices.constData(), vertices.size());
     vboBillboard.release();
     // indices
     iboBillboard.create();
@@ -331,6 +1177,120 @@ void Renderer::initBillboardMemory()
     iboBillboard.release();
 }
 
+//------------------------------------------------------------------------------------------
+// scatter the billboards over the floor, the first one stays at the default position
+//------------------------------------------------------------------------------------------
+void Renderer::initBillboardInstances(int _numBillboards)
+{
+    billboardInstances.resize(_numBillboards);
+    srand(0);
+
+    for(int i = 0; i < _numBillboards; ++i)
+    {
+        BillboardInstance& instance = billboardInstances[i];
+
+        if(i == 0)
+        {
+            instance.scale = DEFAULT_BILLBOARD_OBJECT_SCALE;
+            instance.position = DEFAULT_BILLBOARD_OBJECT_SCALE * DEFAULT_BILLBOARD_OBJECT_POSITION;
+            continue;
+        }
+
+        float x = ((float)rand() / (float)RAND_MAX - 0.5f) * BILLBOARD_FIELD_SIZE;
+        float z = ((float)rand() / (float)RAND_MAX - 0.5f) * BILLBOARD_FIELD_SIZE;
+
+        instance.scale = DEFAULT_BILLBOARD_OBJECT_SCALE * (0.5f + 0.5f * (float)rand() /
+                                                           (float)RAND_MAX);
+        instance.position = QVector3D(x, instance.scale * DEFAULT_BILLBOARD_OBJECT_POSITION.y(), z);
+
+        float shade = 0.8f + 0.2f * (float)rand() / (float)RAND_MAX;
+        instance.tint = QVector4D(shade, shade, shade, 1.0f);
+        instance.textureLayer = (float)(rand() % numBillboardTextureLayers);
+    }
+
+    updateBillboardInstanceData();
+}
+
+//------------------------------------------------------------------------------------------
+// derived data of the billboard instances: the culling grid
+//------------------------------------------------------------------------------------------
+void Renderer::updateBillboardInstanceData()
+{
+    billboardGrid.build(billboardInstances, BILLBOARD_GRID_CELL_SIZE);
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::initBillboardInstanceMemory()
+{
+    if(billboardInstances.isEmpty() && !enabledWorldStreaming)
+    {
+        initBillboardInstances(numSceneBillboards);
+    }
+
+    if(!vboBillboardInstance.isCreated())
+    {
+        vboBillboardInstance.create();
+    }
+
+    vboBillboardInstance.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    vboBillboardInstance.bind();
+    vboBillboardInstance.allocate(billboardInstances.constData(),
+                                  billboardInstances.size() * BillboardInstance::getStructSize());
+    vboBillboardInstance.release();
+
+    numDrawnBillboards = billboardInstances.size();
+}
+
+//------------------------------------------------------------------------------------------
+// the transform feedback object captures the culled instances into a buffer
+// large enough to hold all billboards
+//------------------------------------------------------------------------------------------
+void Renderer::initBillboardCullingMemory()
+{
+    if(!vboBillboardCulledInstance.isCreated())
+    {
+        vboBillboardCulledInstance.create();
+        glGenTransformFeedbacks(1, &TFOBillboardCulling);
+        glGenQueries(1, &queryBillboardCulling);
+    }
+
+    vboBillboardCulledInstance.setUsagePattern(QOpenGLBuffer::StreamCopy);
+    vboBillboardCulledInstance.bind();
+    vboBillboardCulledInstance.allocate(billboardInstances.size() *
+                                        BillboardInstance::getStructSize());
+    vboBillboardCulledInstance.release();
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, TFOBillboardCulling);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, vboBillboardCulledInstance.bufferId());
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+}
+
+//------------------------------------------------------------------------------------------
+// the tree mesh never changes, its instance buffer is refilled every frame
+//------------------------------------------------------------------------------------------
+void Renderer::initLODMeshMemory()
+{
+    if(vboLODMesh.isCreated())
+    {
+        return;
+    }
+
+    vboLODMesh.create();
+    vboLODMesh.bind();
+    vboLODMesh.allocate(treeMesh.getVertices().constData(),
+                        treeMesh.getVertices().size() * sizeof(GLfloat));
+    vboLODMesh.release();
+
+    iboLODMesh.create();
+    iboLODMesh.bind();
+    iboLODMesh.allocate(treeMesh.getIndices().constData(),
+                        treeMesh.getNumIndices() * sizeof(GLushort));
+    iboLODMesh.release();
+
+    vboLODMeshInstance.create();
+    vboLODMeshInstance.setUsagePattern(QOpenGLBuffer::StreamDraw);
+}
+
 //------------------------------------------------------------------------------------------
 // record the buffer state by vertex array object
 //------------------------------------------------------------------------------------------
@@ -338,7 +1298,42 @@ void Renderer::initVertexArrayObjects()
 {
     initPlaneVAO(PHONG_SHADING);
 
-    initBillboardVAO(PHONG_SHADING);
+    initBillboardVAO(BILLBOARD_SHADING);
+    initBillboardVAO(IMPOSTOR_SHADING);
+    initBillboardCullingVAO(BILLBOARD_CULLING, vboBillboardInstance);
+    initBillboardCullingVAO(BILLBOARD_EXPAND_SHADING, vboBillboardCulledInstance);
+    initLODMeshVAO();
+
+    // the full screen triangle has no attributes, but core profile needs a bound vao
+    if(!vaoFullScreen.isCreated())
+    {
+        vaoFullScreen.create();
+    }
+
+    // the attributes of the world chunks are set once their shared buffer exists
+    if(!vaoWorldChunk.isCreated())
+    {
+        vaoWorldChunk.create();
+    }
+
+    vaoWorldChunkBuffer = 0;
+}
+
+//------------------------------------------------------------------------------------------
+// all world chunks are drawn from the shared buffers of the streamer, by their base vertex
+//------------------------------------------------------------------------------------------
+void Renderer::initWorldChunkVAO()
+{
+    stateCache.bindVertexArray(vaoWorldChunk);
+
+    glBindBuffer(GL_ARRAY_BUFFER, worldStreamer.getVertexBuffer());
+    vertexFormat.setupAttribute(this, attrVertex[shadingMode], VERTEX_POSITION);
+    vertexFormat.setupAttribute(this, attrNormal[shadingMode], VERTEX_NORMAL);
+    vertexFormat.setupAttribute(this, attrTexCoord[shadingMode], VERTEX_TEXCOORD);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, worldStreamer.getIndexBuffer());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    vaoWorldChunkBuffer = worldStreamer.getVertexBuffer();
 }
 
 //------------------------------------------------------------------------------------------
@@ -349,22 +1344,13 @@ void Renderer::initPlaneVAO(ShadingProgram _shadingMode)
         vaoPlane[_shadingMode].destroy();
     }
 
-    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
-
     vaoPlane[_shadingMode].create();
     vaoPlane[_shadingMode].bind();
 
     vboPlane.bind();
-    program->enableAttributeArray(attrVertex[_shadingMode]);
-    program->setAttributeBuffer(attrVertex[_shadingMode], GL_FLOAT, 0, 3);
-
-    program->enableAttributeArray(attrNormal[_shadingMode]);
-    program->setAttributeBuffer(attrNormal[_shadingMode], GL_FLOAT,
-                                planeObject->getVertexOffset(), 3);
-
-    program->enableAttributeArray(attrTexCoord[_shadingMode]);
-    program->setAttributeBuffer(attrTexCoord[_shadingMode], GL_FLOAT,
-                                2 * planeObject->getVertexOffset(), 2);
+    vertexFormat.setupAttribute(this, attrVertex[_shadingMode], VERTEX_POSITION);
+    vertexFormat.setupAttribute(this, attrNormal[_shadingMode], VERTEX_NORMAL);
+    vertexFormat.setupAttribute(this, attrTexCoord[_shadingMode], VERTEX_TEXCOORD);
 
     iboPlane.bind();
 
@@ -378,34 +1364,130 @@ void Renderer::initPlaneVAO(ShadingProgram _shadingMode)
 //------------------------------------------------------------------------------------------
 void Renderer::initBillboardVAO(ShadingProgram _shadingMode)
 {
-    if(vaoBillboard[_shadingMode].isCreated())
+    if(vaoBillboard[_shadingMode].isCreated())
+    {
+        vaoBillboard[_shadingMode].destroy();
+    }
+
+    vaoBillboard[_shadingMode].create();
+    vaoBillboard[_shadingMode].bind();
+
+    vboBillboard.bind();
+    vertexFormat.setupAttribute(this, attrVertex[_shadingMode], VERTEX_POSITION);
+
+    // the impostors derive their atlas coordinates from the quad position
+    if(attrTexCoord[_shadingMode] >= 0)
+    {
+        vertexFormat.setupAttribute(this, attrTexCoord[_shadingMode], VERTEX_TEXCOORD);
+    }
+
+    iboBillboard.bind();
+
+    /////////////////////////////////////////////////////////////////
+    // per-instance attributes, advance once per billboard
+    vboBillboardInstance.bind();
+    initInstanceAttributeBuffer(_shadingMode, 1);
+
+    // release vao before vbo and ibo
+    vaoBillboard[_shadingMode].release();
+    vboBillboardInstance.release();
+    vboBillboard.release();
+    iboBillboard.release();
+}
+
+//------------------------------------------------------------------------------------------
+// GPU culling: the culling pass reads one point per billboard from the instance buffer,
+// the expand pass reads the points captured into the culled instance buffer
+//------------------------------------------------------------------------------------------
+void Renderer::initBillboardCullingVAO(ShadingProgram _shadingMode, QOpenGLBuffer& _buffer)
+{
+    if(vaoBillboard[_shadingMode].isCreated())
+    {
+        vaoBillboard[_shadingMode].destroy();
+    }
+
+    vaoBillboard[_shadingMode].create();
+    vaoBillboard[_shadingMode].bind();
+
+    _buffer.bind();
+    initInstanceAttributeBuffer(_shadingMode, 0);
+
+    vaoBillboard[_shadingMode].release();
+    _buffer.release();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::initLODMeshVAO()
+{
+    QOpenGLShaderProgram* program = glslPrograms[LOD_MESH_SHADING];
+
+    if(vaoLODMesh.isCreated())
     {
-        vaoBillboard[_shadingMode].destroy();
+        vaoLODMesh.destroy();
     }
 
-    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
+    vaoLODMesh.create();
+    vaoLODMesh.bind();
 
-    vaoBillboard[_shadingMode].create();
-    vaoBillboard[_shadingMode].bind();
+    vboLODMesh.bind();
+    program->enableAttributeArray(attrVertex[LOD_MESH_SHADING]);
+    program->setAttributeBuffer(attrVertex[LOD_MESH_SHADING], GL_FLOAT, 0, 3,
+                                TreeMesh::getStride());
 
-    vboBillboard.bind();
-    program->enableAttributeArray(attrVertex[_shadingMode]);
-    program->setAttributeBuffer(attrVertex[_shadingMode], GL_FLOAT, 0, 3);
+    program->enableAttributeArray(attrNormal[LOD_MESH_SHADING]);
+    program->setAttributeBuffer(attrNormal[LOD_MESH_SHADING], GL_FLOAT,
+                                TreeMesh::getNormalOffset(), 3, TreeMesh::getStride());
 
-    program->enableAttributeArray(attrNormal[_shadingMode]);
-    program->setAttributeBuffer(attrNormal[_shadingMode], GL_FLOAT,
-                                planeObject->getVertexOffset(), 3);
+    program->enableAttributeArray(attrMeshColor);
+    program->setAttributeBuffer(attrMeshColor, GL_FLOAT, TreeMesh::getColorOffset(), 3,
+                                TreeMesh::getStride());
 
-    program->enableAttributeArray(attrTexCoord[_shadingMode]);
-    program->setAttributeBuffer(attrTexCoord[_shadingMode], GL_FLOAT,
-                                2 * planeObject->getVertexOffset(), 2);
+    iboLODMesh.bind();
 
-    iboBillboard.bind();
+    /////////////////////////////////////////////////////////////////
+    // per-instance attributes, advance once per tree
+    vboLODMeshInstance.bind();
+    initInstanceAttributeBuffer(LOD_MESH_SHADING, 1);
 
     // release vao before vbo and ibo
-    vaoBillboard[_shadingMode].release();
-    vboBillboard.release();
-    iboBillboard.release();
+    vaoLODMesh.release();
+    vboLODMeshInstance.release();
+    vboLODMesh.release();
+    iboLODMesh.release();
+}
+
+//------------------------------------------------------------------------------------------
+// the instance buffer must be bound, it has the layout of BillboardInstance
+//------------------------------------------------------------------------------------------
+void Renderer::initInstanceAttributeBuffer(ShadingProgram _shadingMode, GLuint _divisor)
+{
+    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
+
+    program->enableAttributeArray(attrInstancePosition[_shadingMode]);
+    program->setAttributeBuffer(attrInstancePosition[_shadingMode], GL_FLOAT, 0, 3,
+                                BillboardInstance::getStructSize());
+    glVertexAttribDivisor(attrInstancePosition[_shadingMode], _divisor);
+
+    program->enableAttributeArray(attrInstanceScale[_shadingMode]);
+    program->setAttributeBuffer(attrInstanceScale[_shadingMode], GL_FLOAT,
+                                BillboardInstance::getScaleOffset(), 1,
+                                BillboardInstance::getStructSize());
+    glVertexAttribDivisor(attrInstanceScale[_shadingMode], _divisor);
+
+    program->enableAttributeArray(attrInstanceTint[_shadingMode]);
+    program->setAttributeBuffer(attrInstanceTint[_shadingMode], GL_FLOAT,
+                                BillboardInstance::getTintOffset(), 4,
+                                BillboardInstance::getStructSize());
+    glVertexAttribDivisor(attrInstanceTint[_shadingMode], _divisor);
+
+    if(attrInstanceTextureLayer[_shadingMode] >= 0)
+    {
+        program->enableAttributeArray(attrInstanceTextureLayer[_shadingMode]);
+        program->setAttributeBuffer(attrInstanceTextureLayer[_shadingMode], GL_FLOAT,
+                                    BillboardInstance::getTextureLayerOffset(), 1,
+                                    BillboardInstance::getStructSize());
+        glVertexAttribDivisor(attrInstanceTextureLayer[_shadingMode], _divisor);
+    }
 }
 
 //------------------------------------------------------------------------------------------
@@ -416,58 +1498,213 @@ void Renderer::initSceneMatrices()
     changePlaneSize(30);
     planeNormalMatrix = QMatrix4x4(planeModelMatrix.normalMatrix());
 
-    /////////////////////////////////////////////////////////////////
-    // billboard object
-    billboardObjectModelMatrix.setToIdentity();
-    billboardObjectModelMatrix.scale(4.0f);
-    billboardObjectModelMatrix.translate(DEFAULT_BILLBOARD_OBJECT_POSITION);
 }
 
 
+//------------------------------------------------------------------------------------------
+// accumulation (RGBA16F) and revealage (R16F) targets of the weighted blended transparency,
+// the depth buffer receives the opaque depth before the billboards are drawn
+//------------------------------------------------------------------------------------------
+void Renderer::initTransparencyFramebuffer(int _width, int _height)
+{
+    if(FBOTransparency != 0)
+    {
+        glDeleteFramebuffers(1, &FBOTransparency);
+        glDeleteTextures(1, &texTransparencyAccum);
+        glDeleteTextures(1, &texTransparencyRevealage);
+        glDeleteRenderbuffers(1, &RBOTransparencyDepth);
+    }
+
+    transparencyFramebufferWidth = _width;
+    transparencyFramebufferHeight = _height;
+    transparencyDepthBlitChecked = false;
+
+    GLenum target = (transparencySamples > 0) ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+
+    auto createTarget = [&](GLuint& _texture, GLenum _internalFormat, GLenum _format)
+    {
+        glGenTextures(1, &_texture);
+        glBindTexture(target, _texture);
+
+        if(transparencySamples > 0)
+        {
+            glTexImage2DMultisample(target, transparencySamples, _internalFormat,
+                                    _width, _height, GL_TRUE);
+        }
+        else
+        {
+            glTexImage2D(target, 0, _internalFormat, _width, _height, 0, _format, GL_FLOAT, NULL);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+
+        glBindTexture(target, 0);
+    };
+
+    createTarget(texTransparencyAccum, GL_RGBA16F, GL_RGBA);
+    createTarget(texTransparencyRevealage, GL_R16F, GL_RED);
+
+    // same format and sample count as the combined depth and stencil of the widget,
+    // otherwise the depth blit fails
+    glGenRenderbuffers(1, &RBOTransparencyDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, RBOTransparencyDepth);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, transparencySamples, GL_DEPTH24_STENCIL8,
+                                     _width, _height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &FBOTransparency);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBOTransparency);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target,
+                           texTransparencyAccum, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, target,
+                           texTransparencyRevealage, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              RBOTransparencyDepth);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        PRINT_ERROR("Transparency framebuffer is incomplete.");
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+}
+
 //------------------------------------------------------------------------------------------
 void Renderer::changePlaneSize(int _planeSize)
 {
     planeModelMatrix.setToIdentity();
     planeModelMatrix.scale((float)_planeSize * 2.0f);
+    planeTexCoordScale = (float)_planeSize;
 
-    vboPlane.bind();
-    vboPlane.write(2 * planeObject->getVertexOffset(),
-                   planeObject->getTexureCoordinates((float)_planeSize),
-                   planeObject->getTexCoordOffset());
-    vboPlane.release();
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+// the floor buffers are recreated, so is the vertex array referencing them
+//------------------------------------------------------------------------------------------
+void Renderer::changeFloorSubdivisions(int _numSubdivisions)
+{
+    floorSubdivisions = qBound(1, _numSubdivisions, MAX_FLOOR_SUBDIVISIONS);
+
+    makeCurrent();
+    initPlaneMemory();
+    initPlaneVAO(PHONG_SHADING);
+    stateCache.invalidate();
+    doneCurrent();
+
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::changeNumBillboards(int _numBillboards)
+{
+    numSceneBillboards = qBound(1, _numBillboards, MAX_NUM_BILLBOARDS);
+
+    // the streamed world brings its own billboards
+    if(enabledWorldStreaming)
+    {
+        return;
+    }
+
+    initBillboardInstances(numSceneBillboards);
+
+    makeCurrent();
+    initBillboardInstanceMemory();
+    initBillboardCullingMemory();
+    doneCurrent();
+
+    update();
 }
 
 //------------------------------------------------------------------------------------------
 void Renderer::changeFloorTexture(FloorTexture _texture)
 {
     floorTexture = _texture;
+    update();
 }
 
 //------------------------------------------------------------------------------------------
 void Renderer::changeFloorTextureFilteringMode(QOpenGLTexture::Filter
                                                _textureFiltering)
 {
+    floorTextureFiltering = _textureFiltering;
+
     for(int i = 0; i < NUM_FLOOR_TEXTURES; ++i)
     {
         floorTextures[i]->setMinMagFilters(_textureFiltering, _textureFiltering);
     }
+
+    update();
 }
 //------------------------------------------------------------------------------------------
 void Renderer::updateCamera()
 {
-    zoomCamera();
-
     /////////////////////////////////////////////////////////////////
     // flush camera data to uniform buffer
     viewMatrix.setToIdentity();
     viewMatrix.lookAt(cameraPosition, cameraFocus, cameraUpDirection);
 
     viewProjectionMatrix = projectionMatrix * viewMatrix;
+    viewFrustum.extractPlanes(viewProjectionMatrix);
+}
 
-    glBindBuffer(GL_UNIFORM_BUFFER, UBOMatrices);
-    glBufferSubData(GL_UNIFORM_BUFFER, 2 * SIZE_OF_MAT4, SIZE_OF_MAT4,
-                    viewProjectionMatrix.constData());
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+//------------------------------------------------------------------------------------------
+// each model matrix gets its own Matrices block in the uniform ring buffer,
+// the view-projection matrix of the frame is copied into every block
+//------------------------------------------------------------------------------------------
+GLintptr Renderer::stageMatrices(const QMatrix4x4& _modelMatrix,
+                                 const QMatrix4x4& _normalMatrix)
+{
+    GLfloat matrices[3 * 16];
+    memcpy(&matrices[0], _modelMatrix.constData(), SIZE_OF_MAT4);
+    memcpy(&matrices[16], _normalMatrix.constData(), SIZE_OF_MAT4);
+    memcpy(&matrices[32], viewProjectionMatrix.constData(), SIZE_OF_MAT4);
+
+    return uniformRingBuffer.allocate(matrices, 3 * SIZE_OF_MAT4);
+}
+
+//------------------------------------------------------------------------------------------
+// All Matrices blocks of the frame are staged before the first draw, then uploaded at once:
+// the floor, each visible world chunk, and one block with identity model matrices shared by
+// the instanced draws.
+//------------------------------------------------------------------------------------------
+void Renderer::stageFrameMatrices()
+{
+    floorMatricesOffset = stageMatrices(planeModelMatrix, planeNormalMatrix);
+    identityMatricesOffset = stageMatrices(QMatrix4x4(), QMatrix4x4());
+
+    visibleChunks.resize(0);
+    chunkMatricesOffsets.resize(0);
+
+    if(enabledWorldStreaming)
+    {
+        for(const WorldChunkBuffer& chunk : worldStreamer.getResidentChunks())
+        {
+            if(viewFrustum.classifyBox(chunk.boundMin, chunk.boundMax) == Frustum::OUTSIDE)
+            {
+                continue;
+            }
+
+            QMatrix4x4 modelMatrix;
+            modelMatrix.translate(chunk.center);
+            modelMatrix.scale(0.5f * WORLD_CHUNK_SIZE);
+
+            visibleChunks.append(chunk);
+            chunkMatricesOffsets.append(stageMatrices(modelMatrix,
+                                                      QMatrix4x4(modelMatrix.normalMatrix())));
+        }
+    }
+
+    uniformRingBuffer.flush();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::bindMatrices(GLintptr _blockOffset)
+{
+    stateCache.bindUniformBufferRange(UBOBindingIndex[BINDING_MATRICES],
+                                      uniformRingBuffer.getBufferId(),
+                                      uniformRingBuffer.getFrameOffset() + _blockOffset,
+                                      3 * SIZE_OF_MAT4);
 }
 
 //------------------------------------------------------------------------------------------
@@ -489,6 +1726,10 @@ void Renderer::initializeGL()
 
     checkOpenGLVersion();
 
+    QElapsedTimer programTimer;
+    programTimer.start();
+    programCache.create(context());
+
     if(!initShaderPrograms())
     {
         PRINT_ERROR("Cannot initialize shaders. Exit...");
@@ -496,13 +1737,27 @@ void Renderer::initializeGL()
 
     }
 
+    // a warm start loads all programs from the cache
+    programStartupTime = (double)programTimer.nsecsElapsed() * 1e-6;
+    qDebug() << (numCompiledPrograms == 0 ? "Warm" : "Cold") << "shader startup:"
+             << programStartupTime << "ms," << numCachedPrograms << "programs from cache,"
+             << numCompiledPrograms << "compiled";
+
     initRenderingData();
     initSharedBlockUniform();
     initSceneMatrices();
 
-    glEnable(GL_DEPTH_TEST);
+    TRUE_OR_DIE(impostorAtlas.create(this, treeMesh, defaultFramebufferObject()),
+                "Cannot create the impostor atlas.");
+
+    // the initialization bound objects behind the state cache
+    stateCache.create(this);
+    stateCache.setCapability(GL_DEPTH_TEST, true);
+    frameProfiler.create(this);
 
     changeShadingMode(PHONG_SHADING);
+
+    setSphericalBillboardUniform();
 }
 
 //------------------------------------------------------------------------------------------
@@ -510,20 +1765,75 @@ void Renderer::resizeGL(int w, int h)
 {
     projectionMatrix.setToIdentity();
     projectionMatrix.perspective(45, (float)w / (float)h, 0.1f, 10000.0f);
+
+    initTransparencyFramebuffer(w * retinaScale, h * retinaScale);
+    stateCache.invalidate();
 }
 
 //------------------------------------------------------------------------------------------
 void Renderer::paintGL()
 {
-    translateCamera();
-    rotateCamera();
+    frameProfiler.beginFrame();
+    stateCache.beginFrame();
+
+    {
+        ProfileScope scope(frameProfiler, "Texture upload");
+        uploadDecodedTextures();
+    }
+
+    uniformRingBuffer.beginFrame();
+
+    {
+        ProfileScope scope(frameProfiler, "Camera update");
+        advanceSimulation();
+        updateCamera();
+    }
+
+    if(enabledWorldStreaming)
+    {
+        ProfileScope scope(frameProfiler, "World streaming");
+        updateWorldStreaming();
+    }
 
+    {
+        ProfileScope scope(frameProfiler, "Billboard culling");
+        cullBillboards();
+    }
 
-    updateCamera();
+    {
+        ProfileScope scope(frameProfiler, "Uniform upload");
+        stageFrameMatrices();
+    }
 
     // render scene
     glViewport(0, 0, width() * retinaScale, height() * retinaScale);
     renderScene();
+    stateCache.unbindVertexArray();
+
+    uniformRingBuffer.endFrame();
+
+    frameStatistics.numIssuedGLCalls = stateCache.getNumIssuedCalls();
+    frameStatistics.numSkippedGLCalls = stateCache.getNumSkippedCalls();
+
+    frameProfiler.endFrame();
+
+    bool wasIdle = simulationIdle;
+    simulationIdle = !needsRepaint();
+
+    if(!simulationIdle)
+    {
+        update();
+    }
+
+    // a single frame rendered while idle is also reported as stopped, so that it is shown
+    if(simulationIdle)
+    {
+        emit renderingStopped();
+    }
+    else if(wasIdle)
+    {
+        emit renderingStarted();
+    }
 }
 
 //-----------------------------------------------------------------------------------------
@@ -611,6 +1921,8 @@ void Renderer::changeShadingMode(ShadingProgram _shadingMode)
 {
     shadingMode = _shadingMode;
     currentProgram = glslPrograms[shadingMode];
+    // the attribute locations of the world chunks follow the shading mode
+    vaoWorldChunkBuffer = 0;
 
     update();
 }
@@ -618,9 +1930,9 @@ void Renderer::changeShadingMode(ShadingProgram _shadingMode)
 //------------------------------------------------------------------------------------------
 void Renderer::resetCameraPosition()
 {
-    cameraPosition = DEFAULT_CAMERA_POSITION;
-    cameraFocus = DEFAULT_CAMERA_FOCUS;
-    cameraUpDirection = QVector3D(0.0f, 1.0f, 0.0f);
+    setCameraState(DEFAULT_CAMERA_POSITION, DEFAULT_CAMERA_FOCUS,
+                   QVector3D(0.0f, 1.0f, 0.0f));
+    update();
 }
 
 //------------------------------------------------------------------------------------------
@@ -628,34 +1940,231 @@ void Renderer::enableDepthTest(bool _status)
 {
     makeCurrent();
 
-    if(_status)
+    stateCache.setCapability(GL_DEPTH_TEST, _status);
+
+    doneCurrent();
+
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableZAxisRotation(bool _status)
+{
+    enabledZAxisRotation = _status;
+
+    if(!enabledZAxisRotation)
     {
-        glEnable(GL_DEPTH_TEST);
+        setCameraState(simulatedCamera.position, simulatedCamera.focus,
+                       QVector3D(0.0f, 1.0f, 0.0f));
     }
-    else
+
+    update();
+}
+
+
+//------------------------------------------------------------------------------------------
+// the facing mode only changes on request, so the uniform is not set per frame
+//------------------------------------------------------------------------------------------
+void Renderer::enableSphericalBillboard(bool _state)
+{
+    enabledSphericalBillboard = _state;
+
+    makeCurrent();
+    setSphericalBillboardUniform();
+    doneCurrent();
+
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::setSphericalBillboardUniform()
+{
+    ShadingProgram billboardPrograms[] = {BILLBOARD_SHADING, BILLBOARD_EXPAND_SHADING};
+
+    for(ShadingProgram mode : billboardPrograms)
     {
-        glDisable(GL_DEPTH_TEST);
+        stateCache.setUniform(glslPrograms[mode], uniSphericalBillboard[mode],
+                              enabledSphericalBillboard);
     }
+}
 
-    doneCurrent();
+//------------------------------------------------------------------------------------------
+void Renderer::changeBillboardCullingMode(int _cullingMode)
+{
+    billboardCullingMode = static_cast<BillboardCulling>(_cullingMode);
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::changeBillboardDrawDistance(int _drawDistance)
+{
+    billboardDrawDistance = (float)_drawDistance;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableBillboardSorting(bool _state)
+{
+    enabledBillboardSorting = _state;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::changeBillboardTransparencyMode(int _transparencyMode)
+{
+    billboardTransparency = static_cast<BillboardTransparency>(_transparencyMode);
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+const FrameStatistics& Renderer::getFrameStatistics() const
+{
+    return frameStatistics;
+}
+
+//------------------------------------------------------------------------------------------
+const FrameProfiler& Renderer::getFrameProfiler() const
+{
+    return frameProfiler;
+}
+
+//------------------------------------------------------------------------------------------
+double Renderer::getProgramStartupTime() const
+{
+    return programStartupTime;
+}
+
+//------------------------------------------------------------------------------------------
+int Renderer::getNumCachedPrograms() const
+{
+    return numCachedPrograms;
+}
+
+//------------------------------------------------------------------------------------------
+int Renderer::getNumCompiledPrograms() const
+{
+    return numCompiledPrograms;
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::setCamera(const QVector3D& _position, const QVector3D& _focus)
+{
+    setCameraState(_position, _focus, QVector3D(0.0f, 1.0f, 0.0f));
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::setSimulationFrameTime(double _frameTime)
+{
+    simulationFrameTime = _frameTime;
+}
+
+//------------------------------------------------------------------------------------------
+// render one frame into the widget framebuffer without presenting it,
+// the context must be current
+//------------------------------------------------------------------------------------------
+void Renderer::renderFrame()
+{
+    paintGL();
+}
+
+//------------------------------------------------------------------------------------------
+bool Renderer::hasPendingTextures() const
+{
+    for(int i = 0; i < NUM_FLOOR_TEXTURES; ++i)
+    {
+        if(floorTextureRequests[i] >= 0)
+        {
+            return true;
+        }
+    }
+
+    return !billboardTextureRequests.isEmpty() || !pendingBillboardLayers.isEmpty();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableMeshLOD(bool _state)
+{
+    enabledMeshLOD = _state;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::changeLODDistance(int _lodDistance)
+{
+    lodDistance = (float)_lodDistance;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableWind(bool _state)
+{
+    enabledWind = _state;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::changeWindStrength(int _strength)
+{
+    windStrength = (float)_strength / 100.0f;
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableTextureAnisotropicFiltering(bool _state)
+{
+    enabledTextureAnisotropicFiltering = _state;
+    update();
 }
 
 //------------------------------------------------------------------------------------------
-void Renderer::enableZAxisRotation(bool _status)
+// the plane and billboard buffers are rebuilt, the vertex arrays follow the new layout
+//------------------------------------------------------------------------------------------
+void Renderer::enableCompressedVertexFormat(bool _state)
 {
-    enabledZAxisRotation = _status;
+    vertexFormat = VertexFormat(_state ? COMPRESSED_VERTICES : FULL_PRECISION_VERTICES);
 
-    if(!enabledZAxisRotation)
+    makeCurrent();
+    initPlaneMemory();
+    initBillboardMemory();
+    initVertexArrayObjects();
+    stateCache.invalidate();
+    doneCurrent();
+
+    // the streamed chunks are rebuilt with the new layout
+    if(enabledWorldStreaming)
     {
-        cameraUpDirection = QVector3D(0.0f, 1.0f, 0.0f);
+        enableWorldStreaming(true);
     }
+
+    update();
 }
 
+//------------------------------------------------------------------------------------------
+// continuous rendering repaints every frame, paced by the swap interval (vsync)
+//------------------------------------------------------------------------------------------
+void Renderer::enableContinuousRendering(bool _state)
+{
+    enabledContinuousRendering = _state;
+    update();
+}
 
 //------------------------------------------------------------------------------------------
-void Renderer::enableTextureAnisotropicFiltering(bool _state)
+// on-demand rendering: a new frame is scheduled only while the camera inertia decays,
+// the simulated camera has not settled or textures are still decoding,
+// input and parameter changes request their own frame
+//------------------------------------------------------------------------------------------
+bool Renderer::needsRepaint() const
 {
-    enabledTextureAnisotropicFiltering = _state;
+    return enabledContinuousRendering ||
+           (enabledWind && windStrength > 0.0f) ||
+           hasPendingTextures() ||
+           (enabledWorldStreaming && worldStreamer.isBusy()) ||
+           translation.lengthSquared() >= 1e-4 ||
+           rotation.lengthSquared() >= 1e-4 ||
+           fabs(zooming) >= 1e-4 ||
+           simulatedCamera.position != previousSimulatedCamera.position ||
+           simulatedCamera.focus != previousSimulatedCamera.focus ||
+           simulatedCamera.upDirection != previousSimulatedCamera.upDirection;
 }
 
 //------------------------------------------------------------------------------------------
@@ -669,10 +2178,12 @@ void Renderer::keyPressEvent(QKeyEvent* _event)
 
     case Qt::Key_Plus:
         zooming -= 0.1f;
+        update();
         break;
 
     case Qt::Key_Minus:
         zooming += 0.1f;
+        update();
         break;
 
     default:
@@ -687,7 +2198,87 @@ void Renderer::keyReleaseEvent(QKeyEvent* _event)
 }
 
 //------------------------------------------------------------------------------------------
-void Renderer::translateCamera()
+// a teleport also resets the interpolation, so no in-between camera is rendered
+//------------------------------------------------------------------------------------------
+void Renderer::setCameraState(const QVector3D& _position, const QVector3D& _focus,
+                              const QVector3D& _upDirection)
+{
+    simulatedCamera.position = _position;
+    simulatedCamera.focus = _focus;
+    simulatedCamera.upDirection = _upDirection;
+    previousSimulatedCamera = simulatedCamera;
+
+    cameraPosition = _position;
+    cameraFocus = _focus;
+    cameraUpDirection = _upDirection;
+}
+
+//------------------------------------------------------------------------------------------
+// Fixed-timestep camera simulation: the elapsed time of the monotonic clock is consumed
+// in steps of SIMULATION_TIMESTEP, the remainder interpolates the rendered camera
+// between the two last steps. After an idle period the clock restarts with one step,
+// and a frame never runs more than MAX_SIMULATION_STEPS_PER_FRAME steps.
+//------------------------------------------------------------------------------------------
+void Renderer::advanceSimulation()
+{
+    if(simulationFrameTime > 0.0)
+    {
+        simulationTimeAccumulator += simulationFrameTime;
+    }
+    else if(simulationIdle || !simulationClock.isValid())
+    {
+        simulationClock.start();
+        simulationTimeAccumulator = SIMULATION_TIMESTEP;
+    }
+    else
+    {
+        simulationTimeAccumulator += (double)simulationClock.nsecsElapsed() * 1e-9;
+        simulationClock.restart();
+    }
+
+    int numSteps = 0;
+
+    while(simulationTimeAccumulator >= SIMULATION_TIMESTEP)
+    {
+        if(numSteps == MAX_SIMULATION_STEPS_PER_FRAME)
+        {
+            simulationTimeAccumulator = 0.0;
+            break;
+        }
+
+        stepSimulation();
+        simulationTimeAccumulator -= SIMULATION_TIMESTEP;
+        ++numSteps;
+    }
+
+    float alpha = (float)(simulationTimeAccumulator / SIMULATION_TIMESTEP);
+
+    cameraPosition = previousSimulatedCamera.position +
+                     alpha * (simulatedCamera.position - previousSimulatedCamera.position);
+    cameraFocus = previousSimulatedCamera.focus +
+                  alpha * (simulatedCamera.focus - previousSimulatedCamera.focus);
+    cameraUpDirection = (previousSimulatedCamera.upDirection +
+                         alpha * (simulatedCamera.upDirection -
+                                  previousSimulatedCamera.upDirection)).normalized();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::stepSimulation()
+{
+    previousSimulatedCamera = simulatedCamera;
+
+    if(enabledWind)
+    {
+        windTime += SIMULATION_TIMESTEP;
+    }
+
+    translateCamera(simulatedCamera);
+    rotateCamera(simulatedCamera);
+    zoomCamera(simulatedCamera);
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::translateCamera(CameraState& _camera)
 {
     translation *= MOVING_INERTIA;
 
@@ -696,7 +2287,7 @@ void Renderer::translateCamera()
         return;
     }
 
-    QVector3D eyeVector = cameraFocus - cameraPosition;
+    QVector3D eyeVector = _camera.focus - _camera.position;
     float scale = sqrt(eyeVector.length()) * 0.01f;
 
     QVector3D u(0.0f, 1.0f, 0.0f);
@@ -705,13 +2296,13 @@ void Renderer::translateCamera()
     u.normalize();
     v.normalize();
 
-    cameraPosition -= scale * (translation.x() * v + translation.y() * u);
-    cameraFocus -= scale * (translation.x() * v + translation.y() * u);
+    _camera.position -= scale * (translation.x() * v + translation.y() * u);
+    _camera.focus -= scale * (translation.x() * v + translation.y() * u);
 
 }
 
 //------------------------------------------------------------------------------------------
-void Renderer::rotateCamera()
+void Renderer::rotateCamera(CameraState& _camera)
 {
     rotation *= MOVING_INERTIA;
 
@@ -720,7 +2311,7 @@ void Renderer::rotateCamera()
         return;
     }
 
-    QVector3D nEyeVector = cameraPosition - cameraFocus ;
+    QVector3D nEyeVector = _camera.position - _camera.focus ;
 
     float scale = sqrt(nEyeVector.length()) * 0.02f;
     QQuaternion qRotation = QQuaternion::fromAxisAndAngle(QVector3D(1, 0, 0),
@@ -729,16 +2320,16 @@ void Renderer::rotateCamera()
                             QQuaternion::fromAxisAndAngle(QVector3D(0, 0, 1), rotation.z() * scale);
     nEyeVector = qRotation.rotatedVector(nEyeVector);
 
-    cameraPosition = cameraFocus + nEyeVector;
+    _camera.position = _camera.focus + nEyeVector;
 
     if(enabledZAxisRotation)
     {
-        cameraUpDirection = qRotation.rotatedVector(cameraUpDirection);
+        _camera.upDirection = qRotation.rotatedVector(_camera.upDirection);
     }
 }
 
 //------------------------------------------------------------------------------------------
-void Renderer::zoomCamera()
+void Renderer::zoomCamera(CameraState& _camera)
 {
     zooming *= MOVING_INERTIA;
 
@@ -747,7 +2338,7 @@ void Renderer::zoomCamera()
         return;
     }
 
-    QVector3D nEyeVector = cameraPosition - cameraFocus ;
+    QVector3D nEyeVector = _camera.position - _camera.focus ;
     float len = nEyeVector.length();
     nEyeVector.normalize();
 
@@ -758,8 +2349,142 @@ void Renderer::zoomCamera()
         len = 0.5f;
     }
 
-    cameraPosition = len * nEyeVector + cameraFocus;
+    _camera.position = len * nEyeVector + _camera.focus;
+
+}
+
+//------------------------------------------------------------------------------------------
+// the wind bends the billboard tops by up to WIND_MAX_SWAY times the strength,
+// relative to the billboard scale
+//------------------------------------------------------------------------------------------
+float Renderer::getWindSwayExtent() const
+{
+    return enabledWind ? WIND_MAX_SWAY * windStrength : 0.0f;
+}
+
+//------------------------------------------------------------------------------------------
+// only the billboards intersecting the view frustum and within the draw distance
+// are written into the instance buffer, sorted back to front.
+// GPU culling streams all billboards through the culling pass instead,
+// its visible count is read back from a query of a previous frame without stalling.
+//------------------------------------------------------------------------------------------
+void Renderer::cullBillboards()
+{
+    frameStatistics.numBillboards = billboardInstances.size();
+    frameStatistics.cullTime = 0.0;
+    frameStatistics.sortTime = 0.0;
+    frameStatistics.sortResult = BillboardSorter::NOT_SORTED;
+    frameStatistics.numLODMeshes = 0;
+    numDrawnLODMeshes = 0;
+
+    if(billboardCullingMode != CPU_FRUSTUM_CULLING)
+    {
+        // the buffer already holds every billboard if the previous frame saw them all
+        if(numDrawnBillboards != billboardInstances.size())
+        {
+            initBillboardInstanceMemory();
+        }
+
+        if(billboardCullingMode == NO_CULLING)
+        {
+            frameStatistics.numVisibleBillboards = numDrawnBillboards;
+        }
+        else if(billboardCullingQueryPending)
+        {
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(queryBillboardCulling, GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if(available)
+            {
+                GLuint numVisible = 0;
+                glGetQueryObjectuiv(queryBillboardCulling, GL_QUERY_RESULT, &numVisible);
+                frameStatistics.numVisibleBillboards = (int)numVisible;
+                billboardCullingQueryPending = false;
+            }
+        }
+
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    numDrawnBillboards = billboardGrid.cull(viewFrustum, cameraPosition, billboardDrawDistance,
+                                            getWindSwayExtent(), visibleBillboardInstances);
+
+    frameStatistics.cullTime = (double)timer.nsecsElapsed() * 1e-6;
+    frameStatistics.numVisibleBillboards = numDrawnBillboards;
+
+    /////////////////////////////////////////////////////////////////
+    // blending needs the visible billboards drawn back to front
+    // the tree meshes and the impostors are opaque
+    if(enabledBillboardSorting && billboardTransparency == ALPHA_BLENDING && !enabledMeshLOD &&
+       numDrawnBillboards > 1)
+    {
+        timer.restart();
+        frameStatistics.sortResult = billboardSorter.sort(visibleBillboardInstances,
+                                                          numDrawnBillboards,
+                                                          cameraPosition,
+                                                          (cameraFocus - cameraPosition).normalized(),
+                                                          billboardDrawDistance);
+        frameStatistics.sortTime = (double)timer.nsecsElapsed() * 1e-6;
+    }
+
+    if(enabledMeshLOD)
+    {
+        selectBillboardLOD();
+    }
+
+    if(numDrawnBillboards > 0)
+    {
+        vboBillboardInstance.bind();
+        vboBillboardInstance.allocate(visibleBillboardInstances.constData(),
+                                      numDrawnBillboards * BillboardInstance::getStructSize());
+        vboBillboardInstance.release();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// split the visible billboards by their distance: tree meshes up to the end of the fade
+// range, impostors from its start. The impostors are compacted in place and drawn from
+// the billboard instance buffer, the trees are uploaded to their own instance buffer.
+//------------------------------------------------------------------------------------------
+void Renderer::selectBillboardLOD()
+{
+    float meshDistance = lodDistance + 0.5f * LOD_FADE_RANGE;
+    float impostorDistance = qMax(0.0f, lodDistance - 0.5f * LOD_FADE_RANGE);
+    float meshDistance2 = meshDistance * meshDistance;
+    float impostorDistance2 = impostorDistance * impostorDistance;
+    int numImpostors = 0;
+
+    lodMeshInstances.resize(numDrawnBillboards);
+
+    for(int i = 0; i < numDrawnBillboards; ++i)
+    {
+        const BillboardInstance& instance = visibleBillboardInstances[i];
+        float distance2 = (instance.position - cameraPosition).lengthSquared();
+
+        if(distance2 < meshDistance2)
+        {
+            lodMeshInstances[numDrawnLODMeshes++] = instance;
+        }
+
+        if(distance2 >= impostorDistance2)
+        {
+            visibleBillboardInstances[numImpostors++] = instance;
+        }
+    }
+
+    numDrawnBillboards = numImpostors;
+    frameStatistics.numLODMeshes = numDrawnLODMeshes;
 
+    if(numDrawnLODMeshes > 0)
+    {
+        vboLODMeshInstance.bind();
+        vboLODMeshInstance.allocate(lodMeshInstances.constData(),
+                                    numDrawnLODMeshes * BillboardInstance::getStructSize());
+        vboLODMeshInstance.release();
+    }
 }
 
 //------------------------------------------------------------------------------------------
@@ -770,26 +2495,40 @@ void Renderer::renderScene()
 
 
     // set the data for rendering
-    currentProgram->bind();
+    selectProgramVariant(PHONG_SHADING, getMaterialFeatures(planeMaterial, true));
+    stateCache.useProgram(currentProgram);
     currentProgram->setUniformValue(uniCameraPosition[shadingMode], cameraPosition);
-    currentProgram->setUniformValue(uniObjTexture[shadingMode], 0);
-    currentProgram->setUniformValue(uniEnvTexture[shadingMode], 1);
+    stateCache.setUniform(currentProgram, uniObjTexture[shadingMode], 0);
+    stateCache.setUniform(currentProgram, uniEnvTexture[shadingMode], 1);
 
-    glUniformBlockBinding(currentProgram->programId(), uniMatrices[shadingMode],
-                          UBOBindingIndex[BINDING_MATRICES]);
-    glBindBufferBase(GL_UNIFORM_BUFFER, UBOBindingIndex[BINDING_MATRICES],
-                     UBOMatrices);
+    stateCache.uniformBlockBinding(currentProgram, uniMatrices[shadingMode],
+                                   UBOBindingIndex[BINDING_MATRICES]);
 
-    glUniformBlockBinding(currentProgram->programId(), uniLight[shadingMode],
-                          UBOBindingIndex[BINDING_LIGHT]);
-    glBindBufferBase(GL_UNIFORM_BUFFER, UBOBindingIndex[BINDING_LIGHT],
-                     UBOLight);
+    stateCache.uniformBlockBinding(currentProgram, uniLight[shadingMode],
+                                   UBOBindingIndex[BINDING_LIGHT]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_LIGHT], UBOLight);
 
-    renderFloor();
+    {
+        ProfileScope scope(frameProfiler, "Floor");
+        renderFloor();
+    }
 
+    ProfileScope scope(frameProfiler, "Billboards");
 
-    renderBillboardObject();
-    currentProgram->release();
+    if(billboardCullingMode == GPU_FRUSTUM_CULLING)
+    {
+        cullBillboardsOnGPU();
+        renderGPUCulledBillboards();
+    }
+    else if(enabledMeshLOD && billboardCullingMode == CPU_FRUSTUM_CULLING)
+    {
+        renderLODMeshes();
+        renderImpostors();
+    }
+    else
+    {
+        renderBillboardObject();
+    }
 }
 
 //------------------------------------------------------------------------------------------
@@ -797,85 +2536,390 @@ void Renderer::renderFloor()
 {
     /////////////////////////////////////////////////////////////////
     // flush the model and normal matrices
-    glBindBuffer(GL_UNIFORM_BUFFER, UBOMatrices);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, SIZE_OF_MAT4,
-                    planeModelMatrix.constData());
-    glBufferSubData(GL_UNIFORM_BUFFER, SIZE_OF_MAT4, SIZE_OF_MAT4,
-                    planeNormalMatrix.constData());
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    bindMatrices(floorMatricesOffset);
 
     /////////////////////////////////////////////////////////////////
     // set the uniform
-    currentProgram->setUniformValue(uniHasObjTexture[shadingMode], GL_TRUE);
+    stateCache.uniformBlockBinding(currentProgram, uniMaterial[shadingMode],
+                                   UBOBindingIndex[BINDING_FLOOR_MATERIAL]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_FLOOR_MATERIAL], UBOPlaneMaterial);
+
+    stateCache.bindTexture(0, floorTextures[floorTexture]);
+    stateCache.setTextureMaxAnisotropy(0, floorTextures[floorTexture],
+                                       enabledTextureAnisotropicFiltering ?
+                                       maxTextureAnisotropy : 1.0f);
 
-    glUniformBlockBinding(currentProgram->programId(), uniMaterial[shadingMode],
-                          UBOBindingIndex[BINDING_FLOOR_MATERIAL]);
-    glBindBufferBase(GL_UNIFORM_BUFFER, UBOBindingIndex[BINDING_FLOOR_MATERIAL],
-                     UBOPlaneMaterial);
+    if(enabledWorldStreaming)
+    {
+        renderWorldChunks();
+        return;
+    }
 
     /////////////////////////////////////////////////////////////////
     // render the floor
-    vaoPlane[shadingMode].bind();
-    floorTextures[floorTexture]->bind(0);
+    currentProgram->setUniformValue(uniTexCoordScale[shadingMode], planeTexCoordScale);
+    stateCache.bindVertexArray(vaoPlane[shadingMode]);
+
+    glDrawElements(GL_TRIANGLES, floorMesh.getNumIndices(), floorMesh.getIndexType(), 0);
+}
+
+//------------------------------------------------------------------------------------------
+// only the chunks found visible when staging the matrices are drawn,
+// the texture repeats every 4 units as on the floor
+//------------------------------------------------------------------------------------------
+void Renderer::renderWorldChunks()
+{
+    if(!worldStreamer.getVertexBuffer())
+    {
+        return;
+    }
+
+    currentProgram->setUniformValue(uniTexCoordScale[shadingMode], 0.25f * WORLD_CHUNK_SIZE);
+
+    if(vaoWorldChunkBuffer != worldStreamer.getVertexBuffer())
+    {
+        initWorldChunkVAO();
+    }
+
+    stateCache.bindVertexArray(vaoWorldChunk);
+
+    for(int i = 0; i < visibleChunks.size(); ++i)
+    {
+        bindMatrices(chunkMatricesOffsets[i]);
+        glDrawElementsBaseVertex(GL_TRIANGLES, worldStreamer.getNumIndices(),
+                                 worldStreamer.getIndexType(), 0, visibleChunks[i].baseVertex);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// the billboards of the resident chunks replace the instances when the residency changes,
+// the buffers drawing all billboards are then refilled by the culling
+//------------------------------------------------------------------------------------------
+void Renderer::updateWorldStreaming()
+{
+    if(worldStreamer.update(cameraPosition))
+    {
+        worldStreamer.getBillboardInstances(billboardInstances);
+        updateBillboardInstanceData();
+        initBillboardCullingMemory();
+        numDrawnBillboards = -1;
+    }
+
+    frameStatistics.numResidentChunks = worldStreamer.getResidentChunks().size();
+    frameStatistics.worldResidentBytes = worldStreamer.getResidentBytes();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::enableWorldStreaming(bool _state)
+{
+    enabledWorldStreaming = _state;
+    // a new streamer may reuse the name of the previous vertex buffer
+    vaoWorldChunkBuffer = 0;
+
+    makeCurrent();
 
-    if(enabledTextureAnisotropicFiltering)
+    if(enabledWorldStreaming)
     {
-        GLfloat fLargest;
-        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &fLargest);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, fLargest);
+        WorldParameters parameters;
+        parameters.vertexFormat = vertexFormat;
+        parameters.numTextureLayers = numBillboardTextureLayers;
+        parameters.billboardScale = DEFAULT_BILLBOARD_OBJECT_SCALE;
+        parameters.billboardBaseHeight = DEFAULT_BILLBOARD_OBJECT_POSITION.y();
+        worldStreamer.create(this, parameters);
+
+        billboardInstances.clear();
+        updateBillboardInstanceData();
     }
     else
     {
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, 1.0f);
+        worldStreamer.destroy();
+        initBillboardInstances(numSceneBillboards);
+
+        frameStatistics.numResidentChunks = 0;
+        frameStatistics.worldResidentBytes = 0;
+    }
+
+    initBillboardInstanceMemory();
+    initBillboardCullingMemory();
+    stateCache.invalidate();
+    doneCurrent();
+
+    update();
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::bindBillboardProgram(ShadingProgram _shadingMode)
+{
+    selectProgramVariant(_shadingMode, getBillboardFeatures());
+    QOpenGLShaderProgram* program = glslPrograms[_shadingMode];
+
+    stateCache.useProgram(program);
+    program->setUniformValue(uniCameraPosition[_shadingMode], cameraPosition);
+    stateCache.setUniform(program, uniObjTexture[_shadingMode], 0);
+    stateCache.setUniform(program, uniEnvTexture[_shadingMode], 1);
+    program->setUniformValue(uniBillboardDrawDistance[_shadingMode], billboardDrawDistance);
+
+    // the whole wind animation runs in the shader, its time is interpolated as the camera
+    QVector2D wind = enabledWind ? windStrength * WIND_DIRECTION.normalized() : QVector2D();
+    program->setUniformValue(uniWind[_shadingMode],
+                             QVector3D(wind, (float)(windTime + simulationTimeAccumulator)));
+
+    // the billboards are placed by their instance attributes, not by the model matrix
+    stateCache.uniformBlockBinding(program, uniMatrices[_shadingMode],
+                                   UBOBindingIndex[BINDING_MATRICES]);
+    bindMatrices(identityMatricesOffset);
+
+    stateCache.uniformBlockBinding(program, uniLight[_shadingMode],
+                                   UBOBindingIndex[BINDING_LIGHT]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_LIGHT], UBOLight);
+
+    stateCache.uniformBlockBinding(program, uniMaterial[_shadingMode],
+                                   UBOBindingIndex[BINDING_BILLBOARD_OBJECT_MATERIAL]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_BILLBOARD_OBJECT_MATERIAL],
+                                     UBOBillboardObjectMaterial);
+}
+
+//------------------------------------------------------------------------------------------
+// only alpha blending depends on the drawing order,
+// the other modes keep depth writes and early depth test on.
+// Weighted blended transparency accumulates into its own targets, tested against
+// a copy of the opaque depth, and is composited once the billboards are drawn.
+//------------------------------------------------------------------------------------------
+void Renderer::beginBillboardTransparency()
+{
+    switch(billboardTransparency)
+    {
+    case ALPHA_BLENDING:
+        stateCache.setCapability(GL_BLEND, true);
+        stateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+
+    case ALPHA_TO_COVERAGE:
+        stateCache.setCapability(GL_SAMPLE_ALPHA_TO_COVERAGE, true);
+        break;
+
+    case WEIGHTED_BLENDED_OIT:
+    {
+        const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        const GLfloat clearAccum[] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const GLfloat clearRevealage[] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, defaultFramebufferObject());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, FBOTransparency);
+        // the blit is validated once per framebuffer, glGetError would stall every frame
+        if(!transparencyDepthBlitChecked)
+        {
+            while(glGetError() != GL_NO_ERROR) {}
+        }
+
+        glBlitFramebuffer(0, 0, transparencyFramebufferWidth, transparencyFramebufferHeight,
+                          0, 0, transparencyFramebufferWidth, transparencyFramebufferHeight,
+                          GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        if(!transparencyDepthBlitChecked)
+        {
+            transparencyDepthBlitChecked = true;
+
+            if(glGetError() != GL_NO_ERROR)
+            {
+                PRINT_ERROR("Cannot copy the scene depth into the transparency framebuffer.");
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBOTransparency);
+        glDrawBuffers(2, drawBuffers);
+        glClearBufferfv(GL_COLOR, 0, clearAccum);
+        glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+        glDepthMask(GL_FALSE);
+        stateCache.setCapability(GL_BLEND, true);
+        stateCache.blendFunci(0, GL_ONE, GL_ONE);
+        stateCache.blendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void Renderer::endBillboardTransparency()
+{
+    stateCache.setCapability(GL_BLEND, false);
+    stateCache.setCapability(GL_SAMPLE_ALPHA_TO_COVERAGE, false);
+
+    if(billboardTransparency == WEIGHTED_BLENDED_OIT)
+    {
+        glDepthMask(GL_TRUE);
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+        compositeTransparency();
     }
+}
+
+//------------------------------------------------------------------------------------------
+// a single full screen pass over the opaque scene, whatever the number of billboards
+//------------------------------------------------------------------------------------------
+void Renderer::compositeTransparency()
+{
+    QOpenGLShaderProgram* program = glslPrograms[OIT_COMPOSITE];
+
+    stateCache.useProgram(program);
+    stateCache.setUniform(program, uniAccumTexture, 0);
+    stateCache.setUniform(program, uniRevealageTexture, 1);
+
+    GLenum target = (transparencySamples > 0) ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+    stateCache.bindTexture(0, target, texTransparencyAccum);
+    stateCache.bindTexture(1, target, texTransparencyRevealage);
+
+    bool depthTest = stateCache.isEnabled(GL_DEPTH_TEST);
+    stateCache.setCapability(GL_DEPTH_TEST, false);
+    stateCache.setCapability(GL_BLEND, true);
+    stateCache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
-    floorTextures[floorTexture]->release();
-    vaoPlane[shadingMode].release();
+    stateCache.bindVertexArray(vaoFullScreen);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    stateCache.setCapability(GL_BLEND, false);
+    stateCache.setCapability(GL_DEPTH_TEST, depthTest);
 }
 
+//------------------------------------------------------------------------------------------
+// the billboards are oriented toward the camera in the vertex shader
+// and are drawn by a single instanced draw call
 //------------------------------------------------------------------------------------------
 void Renderer::renderBillboardObject()
 {
+    bindBillboardProgram(BILLBOARD_SHADING);
+
     /////////////////////////////////////////////////////////////////
-    // rotate the billboard to face the camera
-    QVector3D billboardPos = DEFAULT_BILLBOARD_OBJECT_POSITION;
-    QVector3D cameraDir = cameraPosition - cameraFocus;
-    float angle = atan2(billboardPos.x() - cameraDir.x(), billboardPos.z() - cameraDir.z()) ;
+    // render the billboards
+    stateCache.bindVertexArray(vaoBillboard[BILLBOARD_SHADING]);
+    stateCache.bindTexture(0, billboardTexture);
+    beginBillboardTransparency();
+    glDrawElementsInstanced(GL_TRIANGLES, planeObject->getNumIndices(), GL_UNSIGNED_SHORT, 0,
+                            numDrawnBillboards);
+    endBillboardTransparency();
+}
 
-    QMatrix4x4 rotationMatrix = billboardObjectModelMatrix;
-    rotationMatrix.rotate(angle * 180 / M_PI, QVector3D(0.0f, 1.0f, 0.0f));
-    rotationMatrix.rotate(90, QVector3D(1.0f, 0.0f, 0.0f));
-    QMatrix4x4 normalMatrix = -QMatrix4x4(rotationMatrix.normalMatrix());
+//------------------------------------------------------------------------------------------
+// the tree meshes are opaque, they are drawn before the billboards
+// so that blended impostors are composited over them
+//------------------------------------------------------------------------------------------
+void Renderer::renderLODMeshes()
+{
+    if(numDrawnLODMeshes == 0)
+    {
+        return;
+    }
 
-    /////////////////////////////////////////////////////////////////
-    // flush the model and normal matrices
-    glBindBuffer(GL_UNIFORM_BUFFER, UBOMatrices);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, SIZE_OF_MAT4,
-                    rotationMatrix.constData());
-    glBufferSubData(GL_UNIFORM_BUFFER, SIZE_OF_MAT4, SIZE_OF_MAT4,
-                    normalMatrix.constData());
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    QOpenGLShaderProgram* program = glslPrograms[LOD_MESH_SHADING];
 
-    /////////////////////////////////////////////////////////////////
-    // set the uniform
-    currentProgram->setUniformValue(uniHasObjTexture[shadingMode], GL_TRUE);
+    stateCache.useProgram(program);
+    program->setUniformValue(uniCameraPosition[LOD_MESH_SHADING], cameraPosition);
+    program->setUniformValue(uniLODDistance[LOD_MESH_SHADING], lodDistance);
+    program->setUniformValue(uniLODFadeRange[LOD_MESH_SHADING], LOD_FADE_RANGE);
 
-    glUniformBlockBinding(currentProgram->programId(), uniMaterial[shadingMode],
-                          UBOBindingIndex[BINDING_BILLBOARD_OBJECT_MATERIAL]);
-    glBindBufferBase(GL_UNIFORM_BUFFER, UBOBindingIndex[BINDING_BILLBOARD_OBJECT_MATERIAL],
-                     UBOBillboardObjectMaterial);
+    stateCache.uniformBlockBinding(program, uniMatrices[LOD_MESH_SHADING],
+                                   UBOBindingIndex[BINDING_MATRICES]);
+    bindMatrices(identityMatricesOffset);
 
-    /////////////////////////////////////////////////////////////////
-    // render the billboard
-    vaoBillboard[shadingMode].bind();
-    billboardTexture->bind(0);
-    glEnable(GL_BLEND);
-    glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDrawElements(GL_TRIANGLES, planeObject->getNumIndices(), GL_UNSIGNED_SHORT, 0);
-    glDisable(GL_BLEND);
-    billboardTexture->release();
-    vaoBillboard[shadingMode].release();
+    stateCache.uniformBlockBinding(program, uniLight[LOD_MESH_SHADING],
+                                   UBOBindingIndex[BINDING_LIGHT]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_LIGHT], UBOLight);
+
+    stateCache.bindVertexArray(vaoLODMesh);
+    glDrawElementsInstanced(GL_TRIANGLES, treeMesh.getNumIndices(), GL_UNSIGNED_SHORT, 0,
+                            numDrawnLODMeshes);
+}
+
+//------------------------------------------------------------------------------------------
+// the impostors are alpha tested, they need no particular order
+//------------------------------------------------------------------------------------------
+void Renderer::renderImpostors()
+{
+    if(numDrawnBillboards == 0)
+    {
+        return;
+    }
+
+    QOpenGLShaderProgram* program = glslPrograms[IMPOSTOR_SHADING];
+
+    stateCache.useProgram(program);
+    program->setUniformValue(uniCameraPosition[IMPOSTOR_SHADING], cameraPosition);
+    program->setUniformValue(uniLODDistance[IMPOSTOR_SHADING], lodDistance);
+    program->setUniformValue(uniLODFadeRange[IMPOSTOR_SHADING], LOD_FADE_RANGE);
+    stateCache.setUniform(program, uniImpostorGridSize, impostorAtlas.getGridSize());
+    stateCache.setUniform(program, uniImpostorTexture, 0);
+
+    stateCache.uniformBlockBinding(program, uniMatrices[IMPOSTOR_SHADING],
+                                   UBOBindingIndex[BINDING_MATRICES]);
+    bindMatrices(identityMatricesOffset);
+
+    stateCache.uniformBlockBinding(program, uniLight[IMPOSTOR_SHADING],
+                                   UBOBindingIndex[BINDING_LIGHT]);
+    stateCache.bindUniformBufferBase(UBOBindingIndex[BINDING_LIGHT], UBOLight);
+
+    stateCache.bindVertexArray(vaoBillboard[IMPOSTOR_SHADING]);
+    stateCache.bindTexture(0, impostorAtlas.getTexture());
+    glDrawElementsInstanced(GL_TRIANGLES, planeObject->getNumIndices(), GL_UNSIGNED_SHORT, 0,
+                            numDrawnBillboards);
+}
+
+//------------------------------------------------------------------------------------------
+// stream every billboard as a point through the culling geometry shader,
+// the surviving ones are captured into the culled instance buffer
+//------------------------------------------------------------------------------------------
+void Renderer::cullBillboardsOnGPU()
+{
+    QOpenGLShaderProgram* program = glslPrograms[BILLBOARD_CULLING];
+    QVector4D frustumPlanes[Frustum::NUM_PLANES];
+
+    for(int i = 0; i < Frustum::NUM_PLANES; ++i)
+    {
+        frustumPlanes[i] = viewFrustum.getPlane(static_cast<Frustum::Plane>(i));
+    }
+
+    stateCache.useProgram(program);
+    program->setUniformValueArray(uniFrustumPlanes, frustumPlanes, Frustum::NUM_PLANES);
+    program->setUniformValue(uniCameraPosition[BILLBOARD_CULLING], cameraPosition);
+    program->setUniformValue(uniDrawDistance, billboardDrawDistance);
+    program->setUniformValue(uniSwayExtent, getWindSwayExtent());
+
+    stateCache.setCapability(GL_RASTERIZER_DISCARD, true);
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, TFOBillboardCulling);
+
+    if(!billboardCullingQueryPending)
+    {
+        glBeginQuery(GL_PRIMITIVES_GENERATED, queryBillboardCulling);
+    }
+
+    glBeginTransformFeedback(GL_POINTS);
+    stateCache.bindVertexArray(vaoBillboard[BILLBOARD_CULLING]);
+    glDrawArrays(GL_POINTS, 0, billboardInstances.size());
+    glEndTransformFeedback();
 
+    if(!billboardCullingQueryPending)
+    {
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        billboardCullingQueryPending = true;
+    }
+
+    glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
+    stateCache.setCapability(GL_RASTERIZER_DISCARD, false);
+}
+
+//------------------------------------------------------------------------------------------
+// the number of culled billboards stays on the GPU, inside the transform feedback object.
+// Each captured point is expanded into a camera-facing quad by the geometry shader.
+//------------------------------------------------------------------------------------------
+void Renderer::renderGPUCulledBillboards()
+{
+    bindBillboardProgram(BILLBOARD_EXPAND_SHADING);
 
+    stateCache.bindVertexArray(vaoBillboard[BILLBOARD_EXPAND_SHADING]);
+    stateCache.bindTexture(0, billboardTexture);
+    beginBillboardTransparency();
+    glDrawTransformFeedback(GL_POINTS, TFOBillboardCulling);
+    endBillboardTransparency();
 }
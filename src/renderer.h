@@ -14,6 +14,18 @@
 #include <QOpenGLFunctions_4_0_Core>
 
 #include "unitplane.h"
+#include "gridmesh.h"
+#include "treemesh.h"
+#include "impostoratlas.h"
+#include "programcache.h"
+#include "worldstreamer.h"
+#include "billboardinstance.h"
+#include "billboardgrid.h"
+#include "billboardsorter.h"
+#include "textureloader.h"
+#include "uniformringbuffer.h"
+#include "glstatecache.h"
+#include "frameprofiler.h"
 
 //------------------------------------------------------------------------------------------
 #define PRINT_ERROR(_errStr) \
@@ -42,12 +54,36 @@
 #define SIZE_OF_MAT4 (4 * 4 *sizeof(GLfloat))
 #define SIZE_OF_VEC4 (4 * sizeof(GLfloat))
 //------------------------------------------------------------------------------------------
+// the camera damping is applied once per simulation step
 #define MOVING_INERTIA 0.9f
+#define SIMULATION_TIMESTEP (1.0 / 60.0)
+#define MAX_SIMULATION_STEPS_PER_FRAME 8
 #define CUBE_MAP_SIZE 512
 #define DEFAULT_CAMERA_POSITION QVector3D(-4.0f,  5.0f, 15.0f)
 #define DEFAULT_CAMERA_FOCUS QVector3D(-4.0f,  2.0f, 0.0f)
 #define DEFAULT_LIGHT_POSITION QVector3D(0.0f, 100.0f, 100.0f)
 #define DEFAULT_BILLBOARD_OBJECT_POSITION QVector3D(-1.0f, 1.001f, -3.0f)
+#define DEFAULT_BILLBOARD_OBJECT_SCALE 4.0f
+#define DEFAULT_NUM_BILLBOARDS 10000
+#define DEFAULT_FLOOR_SUBDIVISIONS 64
+#define MAX_FLOOR_SUBDIVISIONS 2048
+#define MAX_NUM_BILLBOARDS 1000000
+#define BILLBOARD_FIELD_SIZE 100.0f
+#define BILLBOARD_GRID_CELL_SIZE 10.0f
+#define DEFAULT_BILLBOARD_DRAW_DISTANCE 200.0f
+#define MAX_TEXTURE_UPLOADS_PER_FRAME 4
+// per-draw Matrices blocks a frame region holds before the ring buffer grows
+#define UNIFORM_RING_BLOCKS_PER_FRAME 4096
+#define UNIFORM_RING_NUM_FRAMES 3
+// the tree meshes are drawn up to the LOD distance, the impostors beyond,
+// both are dithered over the fade range around it
+#define DEFAULT_LOD_DISTANCE 30.0f
+#define LOD_FADE_RANGE 6.0f
+// the strength is the bending of the billboard tops, relative to the billboard scale
+#define DEFAULT_WIND_STRENGTH 0.15f
+#define WIND_DIRECTION QVector2D(0.8f, 0.6f)
+// bound of the sway factor of shaders/wind.glsl: gusts up to 1, oscillation 0.3
+#define WIND_MAX_SWAY 1.3f
 
 struct Light
 {
@@ -100,6 +136,46 @@ struct Material
     GLfloat shininess;
 };
 
+struct CameraState
+{
+    QVector3D position;
+    QVector3D focus;
+    QVector3D upDirection;
+};
+
+//------------------------------------------------------------------------------------------
+struct FrameStatistics
+{
+    FrameStatistics():
+        numBillboards(0),
+        numVisibleBillboards(0),
+        cullTime(0.0),
+        sortTime(0.0),
+        sortResult(BillboardSorter::NOT_SORTED),
+        numIssuedGLCalls(0),
+        numSkippedGLCalls(0),
+        numResidentChunks(0),
+        worldResidentBytes(0),
+        numLODMeshes(0) {}
+
+    int numBillboards;
+    int numVisibleBillboards;
+    double cullTime;
+    double sortTime;
+    BillboardSorter::SortResult sortResult;
+
+    // state changes of the previous frame, through the GL state cache
+    int numIssuedGLCalls;
+    int numSkippedGLCalls;
+
+    // streamed world, zero while streaming is disabled
+    int numResidentChunks;
+    int worldResidentBytes;
+
+    // visible billboards drawn as tree meshes, including the cross-faded ones
+    int numLODMeshes;
+};
+
 enum FloorTexture
 {
     CHECKERBOARD = 0,
@@ -110,9 +186,49 @@ enum ShadingProgram
 {
     PHONG_SHADING = 0,
     BILLBOARD_SHADING,
+    BILLBOARD_CULLING,
+    BILLBOARD_EXPAND_SHADING,
+    OIT_COMPOSITE,
+    LOD_MESH_SHADING,
+    IMPOSTOR_SHADING,
     NUM_SHADING_MODE
 };
 
+// features compiled into the shading program variants
+enum ShaderFeature
+{
+    SHADER_OBJECT_TEXTURE = 1 << 0,
+    SHADER_MATERIAL_DIFFUSE = 1 << 1,
+    SHADER_REFLECTION = 1 << 2,
+    // the transparency composite reads multisample targets
+    SHADER_MULTISAMPLE = 1 << 3,
+    // billboard transparency modes, none for alpha blending
+    SHADER_ALPHA_TEST = 1 << 4,
+    SHADER_ALPHA_TO_COVERAGE = 1 << 5,
+    SHADER_HASHED_ALPHA = 1 << 6,
+    SHADER_WEIGHTED_BLENDED_OIT = 1 << 7,
+    // compressed vertices store the normal octahedral-encoded
+    SHADER_OCTAHEDRAL_NORMAL = 1 << 8
+};
+
+enum BillboardCulling
+{
+    NO_CULLING = 0,
+    CPU_FRUSTUM_CULLING,
+    GPU_FRUSTUM_CULLING,
+    NUM_CULLING_MODES
+};
+
+enum BillboardTransparency
+{
+    ALPHA_BLENDING = 0,
+    ALPHA_TEST,
+    ALPHA_TO_COVERAGE,
+    HASHED_ALPHA,
+    WEIGHTED_BLENDED_OIT,
+    NUM_TRANSPARENCY_MODES
+};
+
 
 enum UBOBinding
 {
@@ -128,6 +244,8 @@ enum UBOBinding
 //------------------------------------------------------------------------------------------
 class Renderer : public QOpenGLWidget, QOpenGLFunctions_4_0_Core// QOpenGLFunctions
 {
+    Q_OBJECT
+
 public:
     enum SpecialKey
     {
@@ -156,12 +274,50 @@ public:
     void changeFloorTexture(FloorTexture _texture);
     void changeFloorTextureFilteringMode(QOpenGLTexture::Filter _textureFiltering);
 
+    const FrameStatistics& getFrameStatistics() const;
+    const FrameProfiler& getFrameProfiler() const;
+
+    // time spent creating the shader programs at startup, in ms,
+    // and number of programs loaded from the binary cache or compiled so far
+    double getProgramStartupTime() const;
+    int getNumCachedPrograms() const;
+    int getNumCompiledPrograms() const;
+
+    // scripted camera and frame rendering, for the offscreen benchmark
+    void setCamera(const QVector3D& _position, const QVector3D& _focus);
+    void renderFrame();
+    bool hasPendingTextures() const;
+
+    // a positive frame time advances the simulation by this amount per frame instead of
+    // the elapsed time, so that scripted runs are reproducible
+    void setSimulationFrameTime(double _frameTime);
+
+signals:
+    // sent when frames start being scheduled one after another, and when they stop
+    void renderingStarted();
+    void renderingStopped();
+
 public slots:
     void enableDepthTest(bool _status);
     void enableZAxisRotation(bool _status);
+    void enableSphericalBillboard(bool _state);
+    void changeBillboardCullingMode(int _cullingMode);
+    void changeBillboardDrawDistance(int _drawDistance);
+    void enableBillboardSorting(bool _state);
+    void changeBillboardTransparencyMode(int _transparencyMode);
     void enableTextureAnisotropicFiltering(bool _state);
+    void enableContinuousRendering(bool _state);
+    void enableCompressedVertexFormat(bool _state);
     void resetCameraPosition();
     void changePlaneSize(int _planeSize);
+    void changeFloorSubdivisions(int _numSubdivisions);
+    void enableWorldStreaming(bool _state);
+    void enableMeshLOD(bool _state);
+    void changeLODDistance(int _lodDistance);
+    void enableWind(bool _state);
+    // strength in percent of the billboard scale
+    void changeWindStrength(int _strength);
+    void changeNumBillboards(int _numBillboards);
 
 protected:
     void initializeGL();
@@ -174,45 +330,143 @@ protected:
 
 private:
     void checkOpenGLVersion();
+    bool needsRepaint() const;
+    void setSphericalBillboardUniform();
     bool initShaderPrograms();
-    bool initProgram(ShadingProgram _shadingMode);
+    bool initProgram(ShadingProgram _shadingMode, quint32 _features);
+    void initProgramUniforms(ShadingProgram _shadingMode);
+    QString loadShaderSource(const QString& _fileName, quint32 _features);
+    QOpenGLShaderProgram* compileProgram(ShadingProgram _shadingMode, quint32 _features);
+    void selectProgramVariant(ShadingProgram _shadingMode, quint32 _features);
+    quint32 getMaterialFeatures(const Material& _material, bool _textured) const;
+    quint32 getBillboardFeatures() const;
+    bool initCullingProgram();
+    bool initCompositeProgram();
+    bool initLODMeshProgram();
+    bool initImpostorProgram();
+    void initInstanceAttributes(ShadingProgram _shadingMode);
     void initRenderingData();
     void initSharedBlockUniform();
     void initTexture();
+    void initBillboardTextureArray();
+    void uploadDecodedTextures();
+    void uploadBillboardLayers(int _maxUploads);
+    QOpenGLTexture* createMipmappedTexture(QOpenGLTexture::Target _target,
+                                           const QSize& _size, int _numLayers);
+    void uploadTextureLayer(QOpenGLTexture* _texture, int _layer, const QImage& _image);
+    QOpenGLTexture* createCompressedTexture(QOpenGLTexture::Target _target,
+                                            const CompressedTexture& _compressed,
+                                            int _numLayers);
+    void uploadCompressedLayer(QOpenGLTexture* _texture, int _layer,
+                               const CompressedTexture& _compressed);
     void initSceneMemory();
     void initPlaneMemory();
     void initBillboardMemory();
+    void initBillboardInstances(int _numBillboards);
+    void updateBillboardInstanceData();
+    void initBillboardInstanceMemory();
+    void initBillboardCullingMemory();
+    void initLODMeshMemory();
     void initVertexArrayObjects();
     void initPlaneVAO(ShadingProgram _shadingMode);
     void initBillboardVAO(ShadingProgram _shadingMode);
+    void initBillboardCullingVAO(ShadingProgram _shadingMode, QOpenGLBuffer& _buffer);
+    void initLODMeshVAO();
+    void initWorldChunkVAO();
+    void initInstanceAttributeBuffer(ShadingProgram _shadingMode, GLuint _divisor);
     void initSceneMatrices();
+    void initTransparencyFramebuffer(int _width, int _height);
 
     void updateCamera();
-    void translateCamera();
-    void rotateCamera();
-    void zoomCamera();
+    GLintptr stageMatrices(const QMatrix4x4& _modelMatrix, const QMatrix4x4& _normalMatrix);
+    void stageFrameMatrices();
+    void bindMatrices(GLintptr _blockOffset);
+    void setCameraState(const QVector3D& _position, const QVector3D& _focus,
+                        const QVector3D& _upDirection);
+    void advanceSimulation();
+    void stepSimulation();
+    void translateCamera(CameraState& _camera);
+    void rotateCamera(CameraState& _camera);
+    void zoomCamera(CameraState& _camera);
+    void cullBillboards();
+    float getWindSwayExtent() const;
+    void selectBillboardLOD();
 
     void renderScene();
     void renderFloor();
+    void updateWorldStreaming();
+    void renderWorldChunks();
+    void bindBillboardProgram(ShadingProgram _shadingMode);
     void renderBillboardObject();
+    void renderLODMeshes();
+    void renderImpostors();
+    void beginBillboardTransparency();
+    void endBillboardTransparency();
+    void compositeTransparency();
+    void cullBillboardsOnGPU();
+    void renderGPUCulledBillboards();
 
     QOpenGLTexture* floorTextures[NUM_FLOOR_TEXTURES];
     QOpenGLTexture* billboardTexture;
+    int numBillboardTextureLayers;
+
+    // textures are decoded by the loader, then uploaded through a pixel buffer
+    TextureLoader textureLoader;
+    int floorTextureRequests[NUM_FLOOR_TEXTURES];
+    QVector<int> billboardTextureRequests;
+    // the loaded layers are uploaded into the pending texture within the per-frame budget,
+    // it replaces the billboard texture once complete
+    QOpenGLTexture* pendingBillboardTexture;
+    QVector<LoadedTexture> pendingBillboardLayers;
+    bool pendingBillboardLayersCompressed;
+    int numUploadedBillboardLayers;
+    QOpenGLBuffer pboTextureUpload;
+    bool enabledTextureCache;
+    GLfloat maxTextureAnisotropy;
     UnitPlane* planeObject;
+    GridMesh floorMesh;
+    int floorSubdivisions;
+    // the streamed world replaces the floor and the scattered billboards
+    WorldStreamer worldStreamer;
+    bool enabledWorldStreaming;
+    int numSceneBillboards;
+    // interleaved layout of the plane and billboard vertex buffers
+    VertexFormat vertexFormat;
+    // the floor texture repeats through this scale, the vertices keep texcoords in [0, 1]
+    GLfloat planeTexCoordScale;
 
 
     QMap<ShadingProgram, QString> vertexShaderSourceMap;
+    QMap<ShadingProgram, QString> geometryShaderSourceMap;
     QMap<ShadingProgram, QString> fragmentShaderSourceMap;
     QOpenGLShaderProgram* glslPrograms[NUM_SHADING_MODE];
+    // compiled variants keyed by (shading program << 16 | features)
+    QHash<quint32, QOpenGLShaderProgram*> shaderVariants;
+    quint32 programFeatures[NUM_SHADING_MODE];
+    ProgramCache programCache;
+    int numCachedPrograms;
+    int numCompiledPrograms;
+    double programStartupTime;
     QOpenGLShaderProgram* currentProgram;
     GLuint UBOBindingIndex[NUM_BINDING_POINTS];
-    GLuint UBOMatrices;
+    UniformRingBuffer uniformRingBuffer;
+    // offsets of the Matrices blocks of the frame, from the start of its ring buffer region
+    GLintptr floorMatricesOffset;
+    GLintptr identityMatricesOffset;
+    QVector<WorldChunkBuffer> visibleChunks;
+    QVector<GLintptr> chunkMatricesOffsets;
+    GLStateCache stateCache;
+    FrameProfiler frameProfiler;
     GLuint UBOLight;
     GLuint UBOPlaneMaterial;
     GLuint UBOBillboardObjectMaterial;
     GLint attrVertex[NUM_SHADING_MODE];
     GLint attrNormal[NUM_SHADING_MODE];
     GLint attrTexCoord[NUM_SHADING_MODE];
+    GLint attrInstancePosition[NUM_SHADING_MODE];
+    GLint attrInstanceScale[NUM_SHADING_MODE];
+    GLint attrInstanceTint[NUM_SHADING_MODE];
+    GLint attrInstanceTextureLayer[NUM_SHADING_MODE];
 
     GLint uniMatrices[NUM_SHADING_MODE];
     GLint uniCameraPosition[NUM_SHADING_MODE];
@@ -220,26 +474,73 @@ private:
     GLint uniMaterial[NUM_SHADING_MODE];
     GLint uniObjTexture[NUM_SHADING_MODE];
     GLint uniEnvTexture[NUM_SHADING_MODE];
-    GLint uniHasObjTexture[NUM_SHADING_MODE];
+    GLint uniSphericalBillboard[NUM_SHADING_MODE];
+    GLint uniWind[NUM_SHADING_MODE];
+    GLint uniTexCoordScale[NUM_SHADING_MODE];
+    GLint uniLODDistance[NUM_SHADING_MODE];
+    GLint uniLODFadeRange[NUM_SHADING_MODE];
+    GLint uniBillboardDrawDistance[NUM_SHADING_MODE];
+    GLint attrMeshColor;
+    GLint uniImpostorGridSize;
+    GLint uniImpostorTexture;
+    GLint uniFrustumPlanes;
+    GLint uniAccumTexture;
+    GLint uniRevealageTexture;
+    GLint uniDrawDistance;
+    GLint uniSwayExtent;
 
     QOpenGLVertexArrayObject vaoPlane[NUM_SHADING_MODE];
     QOpenGLVertexArrayObject vaoBillboard[NUM_SHADING_MODE];
     QOpenGLBuffer vboPlane;
     QOpenGLBuffer vboBillboard;
+    QOpenGLBuffer vboBillboardInstance;
+    QOpenGLBuffer vboBillboardCulledInstance;
+    QOpenGLVertexArrayObject vaoLODMesh;
+    QOpenGLBuffer vboLODMesh;
+    QOpenGLBuffer iboLODMesh;
+    QOpenGLBuffer vboLODMeshInstance;
+    GLuint TFOBillboardCulling;
+    GLuint queryBillboardCulling;
+    bool billboardCullingQueryPending;
+
+    // weighted blended order-independent transparency targets
+    QOpenGLVertexArrayObject vaoFullScreen;
+    QOpenGLVertexArrayObject vaoWorldChunk;
+    // vertex buffer of the streamer the attributes of vaoWorldChunk point to
+    GLuint vaoWorldChunkBuffer;
+    GLuint FBOTransparency;
+    GLuint texTransparencyAccum;
+    GLuint texTransparencyRevealage;
+    GLuint RBOTransparencyDepth;
+    // sample count of the widget framebuffer, its depth is blitted into the targets
+    GLint transparencySamples;
+    int transparencyFramebufferWidth;
+    int transparencyFramebufferHeight;
+    bool transparencyDepthBlitChecked;
     QOpenGLBuffer iboPlane;
     QOpenGLBuffer iboBillboard;
 
     Material planeMaterial;
     Material billboardObjectMaterial;
     Light light;
-
+    QVector<BillboardInstance> billboardInstances;
+    QVector<BillboardInstance> visibleBillboardInstances;
+    BillboardGrid billboardGrid;
+    BillboardSorter billboardSorter;
+    int numDrawnBillboards;
+    TreeMesh treeMesh;
+    // far level of the tree meshes, drawn from the billboard instances
+    ImpostorAtlas impostorAtlas;
+    QVector<BillboardInstance> lodMeshInstances;
+    int numDrawnLODMeshes;
+    FrameStatistics frameStatistics;
 
     QMatrix4x4 viewMatrix;
     QMatrix4x4 projectionMatrix;
     QMatrix4x4 viewProjectionMatrix;
+    Frustum viewFrustum;
     QMatrix4x4 planeModelMatrix;
     QMatrix4x4 planeNormalMatrix;
-    QMatrix4x4 billboardObjectModelMatrix;
 
     qreal retinaScale;
     float zooming;
@@ -247,6 +548,14 @@ private:
     QVector3D cameraFocus;
     QVector3D cameraUpDirection;
 
+    // the rendered camera interpolates the two last states of the fixed-timestep simulation
+    CameraState simulatedCamera;
+    CameraState previousSimulatedCamera;
+    QElapsedTimer simulationClock;
+    double simulationTimeAccumulator;
+    double simulationFrameTime;
+    bool simulationIdle;
+
     QVector2D lastMousePos;
     QVector3D translation;
     QVector3D translationLag;
@@ -258,8 +567,21 @@ private:
 
     ShadingProgram shadingMode;
     FloorTexture floorTexture;
+    QOpenGLTexture::Filter floorTextureFiltering;
     bool enabledZAxisRotation;
     bool enabledTextureAnisotropicFiltering;
+    bool enabledSphericalBillboard;
+    BillboardCulling billboardCullingMode;
+    float billboardDrawDistance;
+    bool enabledBillboardSorting;
+    bool enabledContinuousRendering;
+    bool enabledMeshLOD;
+    float lodDistance;
+    bool enabledWind;
+    float windStrength;
+    // advanced by the simulation steps, so the animation is reproducible in scripted runs
+    double windTime;
+    BillboardTransparency billboardTransparency;
 };
 
 #endif // GLRENDERER_H
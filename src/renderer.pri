@@ -0,0 +1,47 @@
+#-------------------------------------------------
+#
+# Renderer sources and resources shared by the application
+# and the headless benchmark
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/unitplane.cpp \
+    $$PWD/renderer.cpp \
+    $$PWD/billboardgrid.cpp \
+    $$PWD/billboardsorter.cpp \
+    $$PWD/frustum.cpp \
+    $$PWD/textureloader.cpp \
+    $$PWD/texturecache.cpp \
+    $$PWD/uniformringbuffer.cpp \
+    $$PWD/glstatecache.cpp \
+    $$PWD/frameprofiler.cpp \
+    $$PWD/vertexformat.cpp \
+    $$PWD/gridmesh.cpp \
+    $$PWD/worldstreamer.cpp \
+    $$PWD/treemesh.cpp \
+    $$PWD/impostoratlas.cpp \
+    $$PWD/programcache.cpp
+
+HEADERS += $$PWD/unitplane.h \
+    $$PWD/renderer.h \
+    $$PWD/billboardinstance.h \
+    $$PWD/billboardgrid.h \
+    $$PWD/billboardsorter.h \
+    $$PWD/frustum.h \
+    $$PWD/textureloader.h \
+    $$PWD/texturecache.h \
+    $$PWD/uniformringbuffer.h \
+    $$PWD/glstatecache.h \
+    $$PWD/frameprofiler.h \
+    $$PWD/vertexformat.h \
+    $$PWD/gridmesh.h \
+    $$PWD/worldstreamer.h \
+    $$PWD/treemesh.h \
+    $$PWD/impostoratlas.h \
+    $$PWD/programcache.h
+
+RESOURCES += \
+    $$PWD/shaders.qrc \
+    $$PWD/textures.qrc
@@ -0,0 +1,256 @@
+//------------------------------------------------------------------------------------------
+// rendererbenchmark.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+// Headless throughput benchmark: the renderer draws a fixed camera path into its
+// offscreen framebuffer, the frame rate, CPU and GPU times are printed as JSON.
+// Usage: RendererBenchmark -platform offscreen [--frames N] [--billboards N]
+//        [--width W] [--height H] [--filtering MODE] [--culling none|cpu|gpu]
+//        [--cold-start] [--wind]
+//------------------------------------------------------------------------------------------
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOpenGLTimerQuery>
+#include <QResizeEvent>
+#include <QSurfaceFormat>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+
+#include "renderer.h"
+
+#define DEFAULT_NUM_FRAMES 500
+#define DEFAULT_WIDTH 1280
+#define DEFAULT_HEIGHT 720
+#define CAMERA_PATH_RADIUS 60.0f
+#define CAMERA_PATH_HEIGHT 10.0f
+#define TEXTURE_WAIT_TIMEOUT_MS 30000
+
+//------------------------------------------------------------------------------------------
+// mean and percentiles of the frame times, in ms
+//------------------------------------------------------------------------------------------
+QJsonObject summarize(QVector<double> _times)
+{
+    QJsonObject summary;
+
+    if(_times.isEmpty())
+    {
+        return summary;
+    }
+
+    std::sort(_times.begin(), _times.end());
+    double sum = 0.0;
+
+    for(double time : _times)
+    {
+        sum += time;
+    }
+
+    auto percentile = [&_times](double _p)
+    {
+        int index = qBound(0, (int)ceil(_p * _times.size()) - 1, _times.size() - 1);
+        return _times[index];
+    };
+
+    summary["mean"] = sum / _times.size();
+    summary["p50"] = percentile(0.50);
+    summary["p90"] = percentile(0.90);
+    summary["p99"] = percentile(0.99);
+    summary["max"] = _times.last();
+
+    return summary;
+}
+
+//------------------------------------------------------------------------------------------
+// one revolution around the billboard field, looking at its center
+//------------------------------------------------------------------------------------------
+void placeCamera(Renderer& _renderer, int _frame, int _numFrames)
+{
+    float angle = 2.0f * (float)M_PI * (float)_frame / (float)_numFrames;
+    QVector3D position(CAMERA_PATH_RADIUS * cos(angle), CAMERA_PATH_HEIGHT,
+                       CAMERA_PATH_RADIUS * sin(angle));
+
+    _renderer.setCamera(position, QVector3D(0.0f, 2.0f, 0.0f));
+}
+
+//------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    /////////////////////////////////////////////////////////////////
+    // command line
+    QMap<QString, QOpenGLTexture::Filter> str2TextureFilteringMap;
+    str2TextureFilteringMap["nearest"] = QOpenGLTexture::Nearest;
+    str2TextureFilteringMap["linear"] = QOpenGLTexture::Linear;
+    str2TextureFilteringMap["nearest-mipmap-nearest"] = QOpenGLTexture::NearestMipMapNearest;
+    str2TextureFilteringMap["nearest-mipmap-linear"] = QOpenGLTexture::NearestMipMapLinear;
+    str2TextureFilteringMap["linear-mipmap-nearest"] = QOpenGLTexture::LinearMipMapNearest;
+    str2TextureFilteringMap["linear-mipmap-linear"] = QOpenGLTexture::LinearMipMapLinear;
+
+    QMap<QString, BillboardCulling> str2CullingMap;
+    str2CullingMap["none"] = NO_CULLING;
+    str2CullingMap["cpu"] = CPU_FRUSTUM_CULLING;
+    str2CullingMap["gpu"] = GPU_FRUSTUM_CULLING;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offscreen rendering benchmark of TextureBillboard");
+    parser.addHelpOption();
+    parser.addOptions(
+    {
+        {"frames", "Number of measured frames.", "N", QString::number(DEFAULT_NUM_FRAMES)},
+        {"billboards", "Number of billboards.", "N", QString::number(DEFAULT_NUM_BILLBOARDS)},
+        {"width", "Framebuffer width.", "W", QString::number(DEFAULT_WIDTH)},
+        {"height", "Framebuffer height.", "H", QString::number(DEFAULT_HEIGHT)},
+        {
+            "filtering", "Floor texture filtering: " +
+            QStringList(str2TextureFilteringMap.keys()).join(", ") + ".",
+            "MODE", "linear-mipmap-linear"
+        },
+        {"culling", "Billboard culling: none, cpu, gpu.", "MODE", "cpu"},
+        {"cold-start", "Clear the program binary cache before starting."},
+        {"wind", "Animate the billboards by the wind."}
+    });
+    parser.process(app);
+
+    int numFrames = qMax(1, parser.value("frames").toInt());
+    int numBillboards = parser.value("billboards").toInt();
+    int width = qMax(1, parser.value("width").toInt());
+    int height = qMax(1, parser.value("height").toInt());
+    QString filtering = parser.value("filtering");
+    QString culling = parser.value("culling");
+
+    TRUE_OR_DIE(str2TextureFilteringMap.contains(filtering), "Unknown filtering mode.");
+    TRUE_OR_DIE(str2CullingMap.contains(culling), "Unknown culling mode.");
+
+    if(parser.isSet("cold-start"))
+    {
+        QDir(ProgramCache::getCacheDirectory()).removeRecursively();
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // the widget is never shown, it renders into its own framebuffer object
+    // created on an offscreen surface
+    QSurfaceFormat format;
+    format.setVersion(4, 1);
+    format.setSamples(4);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    Renderer renderer;
+    renderer.setAttribute(Qt::WA_DontShowOnScreen);
+    renderer.resize(width, height);
+
+    QResizeEvent resizeEvent(QSize(width, height), QSize());
+    QCoreApplication::sendEvent(&renderer, &resizeEvent);
+    TRUE_OR_DIE(renderer.context() && renderer.context()->isValid(),
+                "Cannot create an OpenGL 4.1 core context.");
+
+    renderer.setSimulationFrameTime(SIMULATION_TIMESTEP);
+    renderer.changeNumBillboards(numBillboards);
+    renderer.changeBillboardCullingMode(str2CullingMap[culling]);
+    renderer.enableWind(parser.isSet("wind"));
+
+    renderer.makeCurrent();
+    renderer.changeFloorTextureFilteringMode(str2TextureFilteringMap[filtering]);
+
+    // the textures are decoded in the background, the measure starts once they are used
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+
+    while(renderer.hasPendingTextures() && waitTimer.elapsed() < TEXTURE_WAIT_TIMEOUT_MS)
+    {
+        placeCamera(renderer, 0, numFrames);
+        renderer.renderFrame();
+        QThread::msleep(1);
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // measured frames, the GPU timestamps are read back at the end
+    // so the measure does not serialize CPU and GPU;
+    // timestamps do not conflict with the elapsed time queries of the frame profiler
+    QVector<QOpenGLTimerQuery*> timerQueries(2 * numFrames);
+    QVector<double> cpuTimes(numFrames);
+
+    for(int query = 0; query < timerQueries.size(); ++query)
+    {
+        timerQueries[query] = new QOpenGLTimerQuery;
+        timerQueries[query]->create();
+    }
+
+    renderer.context()->functions()->glFinish();
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    for(int frame = 0; frame < numFrames; ++frame)
+    {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+
+        placeCamera(renderer, frame, numFrames);
+        timerQueries[2 * frame]->recordTimestamp();
+        renderer.renderFrame();
+        timerQueries[2 * frame + 1]->recordTimestamp();
+
+        cpuTimes[frame] = (double)frameTimer.nsecsElapsed() * 1e-6;
+    }
+
+    renderer.context()->functions()->glFinish();
+    double totalTime = (double)totalTimer.nsecsElapsed() * 1e-6;
+
+    QVector<double> gpuTimes;
+
+    for(int frame = 0; frame < numFrames; ++frame)
+    {
+        GLuint64 begin = timerQueries[2 * frame]->waitForTimestamp();
+        GLuint64 end = timerQueries[2 * frame + 1]->waitForTimestamp();
+        gpuTimes.append((double)(end - begin) * 1e-6);
+    }
+
+    qDeleteAll(timerQueries);
+
+    QString glRenderer((const char*)renderer.context()->functions()->glGetString(GL_RENDERER));
+    renderer.doneCurrent();
+
+    /////////////////////////////////////////////////////////////////
+    // report
+    QJsonObject result;
+    result["frames"] = numFrames;
+    result["billboards"] = renderer.getFrameStatistics().numBillboards;
+    result["width"] = width;
+    result["height"] = height;
+    result["filtering"] = filtering;
+    result["culling"] = culling;
+    result["wind"] = parser.isSet("wind");
+    result["renderer"] = glRenderer;
+    result["fps"] = 1000.0 * numFrames / totalTime;
+    result["programStartupMs"] = renderer.getProgramStartupTime();
+    result["cachedPrograms"] = renderer.getNumCachedPrograms();
+    result["compiledPrograms"] = renderer.getNumCompiledPrograms();
+    result["cpuMsPerFrame"] = summarize(cpuTimes);
+    result["gpuMsPerFrame"] = summarize(gpuTimes);
+
+    QJsonObject passes;
+
+    for(const ProfileScopeStatistics& scope : renderer.getFrameProfiler().getStatistics())
+    {
+        passes[scope.name] = QJsonObject {{"cpu", scope.cpuTime}, {"gpu", scope.gpuTime}};
+    }
+
+    result["passMs"] = passes;
+
+    out << QJsonDocument(result).toJson(QJsonDocument::Indented);
+
+    return 0;
+}
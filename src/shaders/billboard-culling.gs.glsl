@@ -0,0 +1,67 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// geometry shader, frustum and distance culling of billboard instances
+// The surviving instances are captured by transform feedback,
+// the outputs have the same layout as BillboardInstance
+//------------------------------------------------------------------------------------------
+
+layout(points) in;
+layout(points, max_vertices = 1) out;
+
+//------------------------------------------------------------------------------------------
+// uniforms
+uniform vec4 frustumPlanes[6];
+uniform vec3 cameraPosition;
+uniform float drawDistance;
+// farthest displacement of the quad corners by the wind, relative to the scale
+uniform float swayExtent;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in INSTANCE
+{
+    vec3 position;
+    float scale;
+    vec4 tint;
+    float texLayer;
+} instance[];
+
+//------------------------------------------------------------------------------------------
+// out variables
+out vec3 o_position;
+out float o_scale;
+out vec4 o_tint;
+out float o_texLayer;
+
+//------------------------------------------------------------------------------------------
+// the quad rotates around its center, so it is bounded by a sphere of radius scale * sqrt(2),
+// grown by the sway of the wind
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 center = instance[0].position;
+    float radius = instance[0].scale * (1.41421356f + swayExtent);
+
+    if(length(center - cameraPosition) - radius > drawDistance)
+    {
+        return;
+    }
+
+    for(int i = 0; i < 6; ++i)
+    {
+        if(dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+        {
+            return;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    o_position = center;
+    o_scale = instance[0].scale;
+    o_tint = instance[0].tint;
+    o_texLayer = instance[0].texLayer;
+
+    EmitVertex();
+    EndPrimitive();
+}
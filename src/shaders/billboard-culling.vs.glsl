@@ -0,0 +1,30 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, pass one billboard instance as a point to the geometry shader
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 i_position;
+in float i_scale;
+in vec4 i_tint;
+in float i_texLayer;
+
+//------------------------------------------------------------------------------------------
+// out variables
+out INSTANCE
+{
+    vec3 position;
+    float scale;
+    vec4 tint;
+    float texLayer;
+} instance;
+
+//------------------------------------------------------------------------------------------
+void main()
+{
+    instance.position = i_position;
+    instance.scale = i_scale;
+    instance.tint = i_tint;
+    instance.texLayer = i_texLayer;
+}
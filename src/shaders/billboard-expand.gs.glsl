@@ -0,0 +1,96 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// geometry shader, expand each culled billboard instance into a camera-facing quad
+//------------------------------------------------------------------------------------------
+
+layout(points) in;
+layout(triangle_strip, max_vertices = 4) out;
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Matrices
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+uniform vec3 cameraPosition;
+uniform bool sphericalBillboard;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in INSTANCE
+{
+    vec3 position;
+    float scale;
+    vec4 tint;
+    float texLayer;
+} instance[];
+
+//------------------------------------------------------------------------------------------
+// out variables
+out VS_OUT
+{
+    vec3 f_normal;
+    vec3 f_lightDir;
+    vec3 f_viewDir;
+    vec2 f_texcoord;
+    vec4 f_tint;
+    flat float f_texLayer;
+};
+
+#include "wind.glsl"
+
+//------------------------------------------------------------------------------------------
+// corners of the unit plane in its xz coordinates, in triangle strip order
+const vec2 corners[4] = vec2[](vec2(-1.0f, -1.0f), vec2(1.0f, -1.0f),
+                               vec2(-1.0f, 1.0f), vec2(1.0f, 1.0f));
+
+//------------------------------------------------------------------------------------------
+// same facing basis as the instanced billboard vertex shader
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 center = instance[0].position;
+    vec3 look = cameraPosition - center;
+
+    if(!sphericalBillboard)
+    {
+        look.y = 0.0f;
+    }
+
+    look = (dot(look, look) > 1e-8f) ? normalize(look) : vec3(0.0f, 0.0f, 1.0f);
+
+    vec3 right = cross(vec3(0.0f, 1.0f, 0.0f), look);
+    right = (dot(right, right) > 1e-8f) ? normalize(right) : vec3(1.0f, 0.0f, 0.0f);
+    vec3 up = cross(look, right);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        vec2 corner = corners[i];
+        vec3 worldCoord = center + instance[0].scale * (corner.x * right - corner.y * up);
+        worldCoord += instance[0].scale * windOffset(center, 0.5f - 0.5f * corner.y);
+
+        /////////////////////////////////////////////////////////////////
+        // output
+        f_normal = look;
+        f_lightDir = vec3(light.position) - worldCoord;
+        f_viewDir = cameraPosition - worldCoord;
+        f_texcoord = corner * 0.5f + 0.5f;
+        f_tint = instance[0].tint;
+        f_texLayer = instance[0].texLayer;
+
+        gl_Position = viewProjectionMatrix * vec4(worldCoord, 1.0);
+        EmitVertex();
+    }
+
+    EndPrimitive();
+}
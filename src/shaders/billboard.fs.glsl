@@ -0,0 +1,160 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// fragment shader, instanced billboard
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+layout(std140) uniform Material
+{
+    vec4 diffuseColor;
+    vec4 specularColor;
+    float reflection;
+    float shininess;
+} material;
+
+#ifdef REFLECTION
+uniform samplerCube envTex;
+#endif
+#ifdef OBJECT_TEXTURE
+uniform sampler2DArray objTex;
+#endif
+uniform vec3 cameraPosition;
+#ifdef WEIGHTED_BLENDED_OIT
+// the view distance of the blending weight is normalized by it
+uniform float drawDistance;
+#endif
+
+//------------------------------------------------------------------------------------------
+// in variables
+in VS_OUT
+{
+    vec3 f_normal;
+    vec3 f_lightDir;
+    vec3 f_viewDir;
+    vec2 f_texcoord;
+    vec4 f_tint;
+    flat float f_texLayer;
+};
+
+//------------------------------------------------------------------------------------------
+// out variables
+layout(location = 0) out vec4 fragColor;
+// only written into the revealage target by the weighted blended OIT mode
+layout(location = 1) out vec4 fragRevealage;
+
+//------------------------------------------------------------------------------------------
+// const variables
+const vec3 ambientLight = vec3(0.2);
+const float alphaCutoff = 0.5f;
+
+//------------------------------------------------------------------------------------------
+// hashed alpha testing (Wyman and McGuire 2017): the threshold is a hash of the
+// world position, quantized at the pixel scale so it stays stable under motion
+//------------------------------------------------------------------------------------------
+float hash2D(vec2 _v)
+{
+    return fract(1.0e4f * sin(17.0f * _v.x + 0.1f * _v.y) * (0.1f + abs(sin(13.0f * _v.y + _v.x))));
+}
+
+float hash3D(vec3 _v)
+{
+    return hash2D(vec2(hash2D(_v.xy), _v.z));
+}
+
+float hashedAlphaThreshold(vec3 _worldCoord)
+{
+    float maxDeriv = max(length(dFdx(_worldCoord)), length(dFdy(_worldCoord)));
+    float pixScale = 1.0f / max(maxDeriv, 1e-6f);
+    vec2 pixScales = vec2(exp2(floor(log2(pixScale))), exp2(ceil(log2(pixScale))));
+    vec2 thresholds = vec2(hash3D(floor(pixScales.x * _worldCoord)),
+                           hash3D(floor(pixScales.y * _worldCoord)));
+
+    return clamp(mix(thresholds.x, thresholds.y, fract(log2(pixScale))), 1e-6f, 1.0f);
+}
+
+//------------------------------------------------------------------------------------------
+// Same shading as the phong shader, the vertex color is replaced by the instance tint
+// which also modulates the texture color and alpha.
+// The material features are compiled in as in the phong shader, so is the transparency
+// mode: ALPHA_TEST, ALPHA_TO_COVERAGE, HASHED_ALPHA, WEIGHTED_BLENDED_OIT or none for
+// alpha blending. Except for alpha blending, the modes do not depend on the drawing order.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 normal = normalize(f_normal);
+    vec3 lightDir = normalize(f_lightDir);
+    vec3 viewDir = normalize(f_viewDir);
+
+    float alpha = 1.0f;
+    vec3 surfaceColor = vec3(0.0f);
+
+#ifdef OBJECT_TEXTURE
+    vec4 texVal = texture(objTex, vec3(f_texcoord, f_texLayer));
+    surfaceColor = texVal.xyz;
+    alpha = texVal.w;
+#endif
+
+#ifdef MATERIAL_DIFFUSE
+    surfaceColor = mix(vec3(material.diffuseColor), surfaceColor, alpha);
+#endif
+
+    surfaceColor *= vec3(f_tint);
+    alpha *= f_tint.w;
+
+    /////////////////////////////////////////////////////////////////
+    // order-independent modes, discarded fragments skip the lighting
+#if defined(ALPHA_TEST)
+    if(alpha < alphaCutoff)
+    {
+        discard;
+    }
+
+    alpha = 1.0f;
+#elif defined(ALPHA_TO_COVERAGE)
+    // sharpen the alpha around the cutoff so the coverage mask gives crisp edges
+    alpha = clamp((alpha - alphaCutoff) / max(fwidth(alpha), 1e-4f) + 0.5f, 0.0f, 1.0f);
+#elif defined(HASHED_ALPHA)
+    if(alpha < hashedAlphaThreshold(cameraPosition - f_viewDir))
+    {
+        discard;
+    }
+
+    alpha = 1.0f;
+#endif
+
+    vec3 ambient = ambientLight * surfaceColor;
+    vec3 diffuse = vec3(max(dot(normal, lightDir), 0.0f)) * surfaceColor;
+
+    vec3 halfDir = normalize(lightDir + viewDir);
+    vec3 specular = pow(max(dot(halfDir, normal), 0.0f), material.shininess) * vec3(material.specularColor);
+
+    vec3 shadedColor = light.intensity * (ambient + diffuse + specular);
+
+#ifdef REFLECTION
+    vec3 reflectionDir = reflect(-viewDir, normal);
+    vec3 reflection = texture(envTex, reflectionDir).xyz;
+    shadedColor = mix(shadedColor, reflection, material.reflection);
+#endif
+
+    /////////////////////////////////////////////////////////////////
+    // output
+#ifdef WEIGHTED_BLENDED_OIT
+    // McGuire and Bavoil 2013, weight decreasing with the view distance
+    float viewDistance = length(f_viewDir) / max(drawDistance, 1e-3f);
+    float weight = alpha * clamp(0.03f / (1e-5f + pow(viewDistance, 4.0f)), 1e-2f, 3e3f);
+
+    fragColor = vec4(shadedColor * alpha, alpha) * weight;
+    fragRevealage = vec4(alpha);
+#else
+    fragColor = vec4(shadedColor, alpha);
+#endif
+
+}
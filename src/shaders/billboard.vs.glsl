@@ -0,0 +1,86 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, instanced billboard
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Matrices
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+uniform vec3 cameraPosition;
+uniform bool sphericalBillboard;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 v_coord;
+in vec2 v_texcoord;
+
+// per-instance variables
+in vec3 i_position;
+in float i_scale;
+in vec4 i_tint;
+in float i_texLayer;
+
+//------------------------------------------------------------------------------------------
+// out variables
+out VS_OUT
+{
+    vec3 f_normal;
+    vec3 f_lightDir;
+    vec3 f_viewDir;
+    vec2 f_texcoord;
+    vec4 f_tint;
+    flat float f_texLayer;
+};
+
+#include "wind.glsl"
+
+//------------------------------------------------------------------------------------------
+// The facing basis is built per instance from the camera position:
+// cylindrical billboards only rotate around the world up axis,
+// spherical billboards fully turn toward the camera.
+// The unit plane lies in the xz plane, its z axis is mapped to the billboard up axis.
+// The texture v coordinate is 1 at the root of the billboard, 0 at its top.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 look = cameraPosition - i_position;
+
+    if(!sphericalBillboard)
+    {
+        look.y = 0.0f;
+    }
+
+    look = (dot(look, look) > 1e-8f) ? normalize(look) : vec3(0.0f, 0.0f, 1.0f);
+
+    vec3 right = cross(vec3(0.0f, 1.0f, 0.0f), look);
+    right = (dot(right, right) > 1e-8f) ? normalize(right) : vec3(1.0f, 0.0f, 0.0f);
+    vec3 up = cross(look, right);
+
+    vec3 worldCoord = i_position + i_scale * (v_coord.x * right - v_coord.z * up);
+    worldCoord += i_scale * windOffset(i_position, 1.0f - v_texcoord.y);
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    f_normal = look;
+    f_lightDir = vec3(light.position) - worldCoord;
+    f_viewDir = cameraPosition - worldCoord;
+    f_texcoord = v_texcoord;
+    f_tint = i_tint;
+    f_texLayer = i_texLayer;
+
+
+    gl_Position = viewProjectionMatrix * vec4(worldCoord, 1.0);
+}
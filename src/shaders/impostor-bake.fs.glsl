@@ -0,0 +1,22 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// fragment shader, octahedral impostor baking
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 f_normal;
+in vec3 f_color;
+in float f_depth;
+
+//------------------------------------------------------------------------------------------
+// out variables, the two layers of the atlas
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 fragNormalDepth;
+
+//------------------------------------------------------------------------------------------
+void main()
+{
+    fragColor = vec4(f_color, 1.0f);
+    fragNormalDepth = vec4(normalize(f_normal) * 0.5f + 0.5f, f_depth * 0.5f + 0.5f);
+}
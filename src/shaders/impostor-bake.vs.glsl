@@ -0,0 +1,77 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, octahedral impostor baking: one instance per view of the atlas
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+uniform int gridSize;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 v_coord;
+in vec3 v_normal;
+in vec3 v_color;
+
+//------------------------------------------------------------------------------------------
+// out variables
+out vec3 f_normal;
+out vec3 f_color;
+out float f_depth;
+
+out float gl_ClipDistance[4];
+
+//------------------------------------------------------------------------------------------
+// full sphere octahedral mapping, the upper hemisphere fills the center diamond
+//------------------------------------------------------------------------------------------
+vec3 octahedralDecode(vec2 _e)
+{
+    vec3 n = vec3(_e.x, 1.0f - abs(_e.x) - abs(_e.y), _e.y);
+
+    if(n.y < 0.0f)
+    {
+        n.xz = (1.0f - abs(n.zx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.z >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return normalize(n);
+}
+
+//------------------------------------------------------------------------------------------
+// same view basis as the impostor vertex shader
+//------------------------------------------------------------------------------------------
+void viewBasis(vec3 _view, out vec3 _right, out vec3 _up)
+{
+    vec3 reference = (abs(_view.y) > 0.999f) ? vec3(0.0f, 0.0f, -1.0f) : vec3(0.0f, 1.0f, 0.0f);
+    _right = normalize(cross(reference, _view));
+    _up = cross(_view, _right);
+}
+
+//------------------------------------------------------------------------------------------
+// Each instance renders an orthographic view of the unit box into its own atlas cell,
+// the clip distances keep it inside the cell. The normal stays in world space,
+// the depth is the distance toward the viewer along the view direction.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec2 cell = vec2(gl_InstanceID % gridSize, gl_InstanceID / gridSize);
+    vec3 view = octahedralDecode(cell / float(gridSize - 1) * 2.0f - 1.0f);
+    vec3 right;
+    vec3 up;
+    viewBasis(view, right, up);
+
+    vec3 local = vec3(dot(v_coord, right), dot(v_coord, up), dot(v_coord, view));
+    vec2 atlasCoord = (cell + 0.5f + 0.5f * local.xy) / float(gridSize);
+
+    gl_ClipDistance[0] = 1.0f + local.x;
+    gl_ClipDistance[1] = 1.0f - local.x;
+    gl_ClipDistance[2] = 1.0f + local.y;
+    gl_ClipDistance[3] = 1.0f - local.y;
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    f_normal = v_normal;
+    f_color = v_color;
+    f_depth = local.z;
+
+    gl_Position = vec4(atlasCoord * 2.0f - 1.0f, -0.5f * local.z, 1.0f);
+}
@@ -0,0 +1,55 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// fragment shader, instanced tree mesh of the billboard LOD
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 f_normal;
+in vec3 f_lightDir;
+in vec3 f_color;
+flat in float f_impostorWeight;
+
+//------------------------------------------------------------------------------------------
+// out variables
+layout(location = 0) out vec4 fragColor;
+
+//------------------------------------------------------------------------------------------
+// const variables
+const vec3 ambientLight = vec3(0.2);
+
+// 4x4 ordered dither, the impostor shader keeps the complementary pixels
+const float bayerMatrix[16] = float[](0.0f, 8.0f, 2.0f, 10.0f,
+                                      12.0f, 4.0f, 14.0f, 6.0f,
+                                      3.0f, 11.0f, 1.0f, 9.0f,
+                                      15.0f, 7.0f, 13.0f, 5.0f);
+
+//------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+    if((bayerMatrix[4 * pixel.y + pixel.x] + 0.5f) / 16.0f < f_impostorWeight)
+    {
+        discard;
+    }
+
+    vec3 normal = normalize(f_normal);
+    vec3 lightDir = normalize(f_lightDir);
+
+    vec3 ambient = ambientLight * f_color;
+    vec3 diffuse = vec3(max(dot(normal, lightDir), 0.0f)) * f_color;
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    fragColor = vec4(light.intensity * (ambient + diffuse), 1.0f);
+}
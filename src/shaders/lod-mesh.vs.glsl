@@ -0,0 +1,61 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, instanced tree mesh of the billboard LOD
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Matrices
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+uniform vec3 cameraPosition;
+uniform float lodDistance;
+uniform float lodFadeRange;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 v_coord;
+in vec3 v_normal;
+in vec3 v_color;
+
+// per-instance variables, same layout as the billboards
+in vec3 i_position;
+in float i_scale;
+in vec4 i_tint;
+
+//------------------------------------------------------------------------------------------
+// out variables
+out vec3 f_normal;
+out vec3 f_lightDir;
+out vec3 f_color;
+flat out float f_impostorWeight;
+
+//------------------------------------------------------------------------------------------
+// the mesh fills the box of its billboard: placed by the instance position and scaled
+// uniformly, it is not turned toward the camera
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 worldCoord = i_position + i_scale * v_coord;
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    f_normal = v_normal;
+    f_lightDir = vec3(light.position) - worldCoord;
+    f_color = v_color * vec3(i_tint);
+    f_impostorWeight = clamp((distance(cameraPosition, i_position) - lodDistance) / lodFadeRange +
+                             0.5f, 0.0f, 1.0f);
+
+    gl_Position = viewProjectionMatrix * vec4(worldCoord, 1.0);
+}
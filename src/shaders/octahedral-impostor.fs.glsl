@@ -0,0 +1,116 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// fragment shader, instanced octahedral impostor
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Matrices
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+layout(std140) uniform Light
+{
+    vec4 position;
+    vec4 color;
+    float intensity;
+} light;
+
+// layer 0: color and alpha, layer 1: world normal and depth toward the viewer
+uniform sampler2DArray impostorTex;
+uniform int gridSize;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 f_worldCoord;
+in vec4 f_tint;
+in vec2 f_viewCoord0;
+in vec2 f_viewCoord1;
+in vec2 f_viewCoord2;
+flat in vec2 f_cell0;
+flat in vec2 f_cell1;
+flat in vec2 f_cell2;
+flat in vec3 f_viewWeights;
+flat in vec3 f_look;
+flat in float f_scale;
+flat in float f_impostorWeight;
+
+//------------------------------------------------------------------------------------------
+// out variables
+layout(location = 0) out vec4 fragColor;
+
+//------------------------------------------------------------------------------------------
+// const variables
+const vec3 ambientLight = vec3(0.2);
+const float alphaCutoff = 0.5f;
+
+// 4x4 ordered dither of the LOD cross-fade, the tree mesh keeps the complementary pixels
+const float bayerMatrix[16] = float[](0.0f, 8.0f, 2.0f, 10.0f,
+                                      12.0f, 4.0f, 14.0f, 6.0f,
+                                      3.0f, 11.0f, 1.0f, 9.0f,
+                                      15.0f, 7.0f, 13.0f, 5.0f);
+
+//------------------------------------------------------------------------------------------
+// a view only contributes inside its own cell, its neighbours do not bleed in
+//------------------------------------------------------------------------------------------
+void sampleView(vec2 _cell, vec2 _viewCoord, float _weight,
+                inout vec4 _color, inout vec4 _normalDepth, inout float _totalWeight)
+{
+    if(_weight <= 0.0f || any(greaterThan(abs(_viewCoord), vec2(1.0f))))
+    {
+        return;
+    }
+
+    vec2 atlasCoord = (_cell + 0.5f + 0.5f * _viewCoord) / float(gridSize);
+    _color += _weight * texture(impostorTex, vec3(atlasCoord, 0.0f));
+    _normalDepth += _weight * texture(impostorTex, vec3(atlasCoord, 1.0f));
+    _totalWeight += _weight;
+}
+
+//------------------------------------------------------------------------------------------
+// The impostors are alpha tested and opaque. The baked depth moves the fragment toward
+// the viewer, so the impostors intersect the ground and each other like the mesh would.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+
+    if((bayerMatrix[4 * pixel.y + pixel.x] + 0.5f) / 16.0f >= f_impostorWeight)
+    {
+        discard;
+    }
+
+    vec4 color = vec4(0.0f);
+    vec4 normalDepth = vec4(0.0f);
+    float totalWeight = 0.0f;
+
+    sampleView(f_cell0, f_viewCoord0, f_viewWeights.x, color, normalDepth, totalWeight);
+    sampleView(f_cell1, f_viewCoord1, f_viewWeights.y, color, normalDepth, totalWeight);
+    sampleView(f_cell2, f_viewCoord2, f_viewWeights.z, color, normalDepth, totalWeight);
+
+    if(totalWeight <= 0.0f || color.w < alphaCutoff * totalWeight)
+    {
+        discard;
+    }
+
+    color /= totalWeight;
+    normalDepth /= totalWeight;
+
+    vec3 worldCoord = f_worldCoord + f_look * (normalDepth.w * 2.0f - 1.0f) * f_scale;
+    vec4 clipCoord = viewProjectionMatrix * vec4(worldCoord, 1.0f);
+    gl_FragDepth = 0.5f * clipCoord.z / clipCoord.w + 0.5f;
+
+    vec3 surfaceColor = color.xyz * vec3(f_tint);
+    vec3 normal = normalize(normalDepth.xyz * 2.0f - 1.0f);
+    vec3 lightDir = normalize(vec3(light.position) - worldCoord);
+
+    vec3 ambient = ambientLight * surfaceColor;
+    vec3 diffuse = vec3(max(dot(normal, lightDir), 0.0f)) * surfaceColor;
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    fragColor = vec4(light.intensity * (ambient + diffuse), 1.0f);
+}
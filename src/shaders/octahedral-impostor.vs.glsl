@@ -0,0 +1,149 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, instanced octahedral impostor
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+layout(std140) uniform Matrices
+{
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+    mat4 viewProjectionMatrix;
+};
+
+uniform vec3 cameraPosition;
+uniform int gridSize;
+uniform float lodDistance;
+uniform float lodFadeRange;
+
+//------------------------------------------------------------------------------------------
+// in variables
+in vec3 v_coord;
+
+// per-instance variables, same layout as the billboards
+in vec3 i_position;
+in float i_scale;
+in vec4 i_tint;
+
+//------------------------------------------------------------------------------------------
+// out variables
+out vec3 f_worldCoord;
+out vec4 f_tint;
+// position on the quad seen from each of the three nearest atlas views
+out vec2 f_viewCoord0;
+out vec2 f_viewCoord1;
+out vec2 f_viewCoord2;
+flat out vec2 f_cell0;
+flat out vec2 f_cell1;
+flat out vec2 f_cell2;
+flat out vec3 f_viewWeights;
+flat out vec3 f_look;
+flat out float f_scale;
+flat out float f_impostorWeight;
+
+//------------------------------------------------------------------------------------------
+float signNotZero(float _v)
+{
+    return (_v >= 0.0f) ? 1.0f : -1.0f;
+}
+
+//------------------------------------------------------------------------------------------
+// same full sphere octahedral mapping as the impostor baking
+//------------------------------------------------------------------------------------------
+vec2 octahedralEncode(vec3 _n)
+{
+    vec3 n = _n / (abs(_n.x) + abs(_n.y) + abs(_n.z));
+
+    if(n.y < 0.0f)
+    {
+        return (1.0f - abs(n.zx)) * vec2(signNotZero(n.x), signNotZero(n.z));
+    }
+
+    return n.xz;
+}
+
+vec3 octahedralDecode(vec2 _e)
+{
+    vec3 n = vec3(_e.x, 1.0f - abs(_e.x) - abs(_e.y), _e.y);
+
+    if(n.y < 0.0f)
+    {
+        n.xz = (1.0f - abs(n.zx)) * vec2(signNotZero(n.x), signNotZero(n.z));
+    }
+
+    return normalize(n);
+}
+
+//------------------------------------------------------------------------------------------
+void viewBasis(vec3 _view, out vec3 _right, out vec3 _up)
+{
+    vec3 reference = (abs(_view.y) > 0.999f) ? vec3(0.0f, 0.0f, -1.0f) : vec3(0.0f, 1.0f, 0.0f);
+    _right = normalize(cross(reference, _view));
+    _up = cross(_view, _right);
+}
+
+//------------------------------------------------------------------------------------------
+// the quad point projected into the view of an atlas cell
+//------------------------------------------------------------------------------------------
+vec2 viewCoord(vec2 _cell, vec3 _local)
+{
+    vec3 right;
+    vec3 up;
+    viewBasis(octahedralDecode(_cell / float(gridSize - 1) * 2.0f - 1.0f), right, up);
+
+    return vec2(dot(_local, right), dot(_local, up));
+}
+
+//------------------------------------------------------------------------------------------
+// The quad fully faces the camera. The direction toward the camera falls into a triangle
+// of the octahedral view grid, its three corners are the blended views, weighted by the
+// barycentric coordinates of the direction.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec3 look = cameraPosition - i_position;
+    look = (dot(look, look) > 1e-8f) ? normalize(look) : vec3(0.0f, 0.0f, 1.0f);
+
+    vec3 right;
+    vec3 up;
+    viewBasis(look, right, up);
+
+    vec3 local = v_coord.x * right - v_coord.z * up;
+    vec3 worldCoord = i_position + i_scale * local;
+
+    /////////////////////////////////////////////////////////////////
+    // three nearest views
+    vec2 grid = (octahedralEncode(look) * 0.5f + 0.5f) * float(gridSize - 1);
+    vec2 base = clamp(floor(grid), vec2(0.0f), vec2(float(gridSize - 2)));
+    vec2 f = grid - base;
+
+    if(f.x + f.y < 1.0f)
+    {
+        f_cell0 = base;
+        f_viewWeights = vec3(1.0f - f.x - f.y, f.x, f.y);
+    }
+    else
+    {
+        f_cell0 = base + vec2(1.0f, 1.0f);
+        f_viewWeights = vec3(f.x + f.y - 1.0f, 1.0f - f.y, 1.0f - f.x);
+    }
+
+    f_cell1 = base + vec2(1.0f, 0.0f);
+    f_cell2 = base + vec2(0.0f, 1.0f);
+
+    f_viewCoord0 = viewCoord(f_cell0, local);
+    f_viewCoord1 = viewCoord(f_cell1, local);
+    f_viewCoord2 = viewCoord(f_cell2, local);
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    f_worldCoord = worldCoord;
+    f_tint = i_tint;
+    f_look = look;
+    f_scale = i_scale;
+    f_impostorWeight = clamp((distance(cameraPosition, i_position) - lodDistance) / lodFadeRange +
+                             0.5f, 0.0f, 1.0f);
+
+    gl_Position = viewProjectionMatrix * vec4(worldCoord, 1.0);
+}
@@ -0,0 +1,47 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// fragment shader, composite the weighted blended transparency over the opaque scene
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+// uniforms
+#ifdef MULTISAMPLE
+uniform sampler2DMS accumTex;
+uniform sampler2DMS revealageTex;
+#else
+uniform sampler2D accumTex;
+uniform sampler2D revealageTex;
+#endif
+
+//------------------------------------------------------------------------------------------
+// out variables
+out vec4 fragColor;
+
+//------------------------------------------------------------------------------------------
+// The accumulation target holds the weighted sum of premultiplied colors and alphas,
+// the revealage target holds the product of (1 - alpha) of all transparent fragments.
+// The result is blended with (SRC_ALPHA, ONE_MINUS_SRC_ALPHA).
+// With multisample targets, reading gl_SampleID composites each sample on its own.
+//------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+#ifdef MULTISAMPLE
+    int sampleIndex = gl_SampleID;
+#else
+    int sampleIndex = 0;
+#endif
+    float revealage = texelFetch(revealageTex, texel, sampleIndex).r;
+
+    if(revealage >= 1.0f)
+    {
+        discard;
+    }
+
+    vec4 accum = texelFetch(accumTex, texel, sampleIndex);
+    vec3 averageColor = accum.rgb / clamp(accum.a, 1e-4f, 5e4f);
+
+    /////////////////////////////////////////////////////////////////
+    // output
+    fragColor = vec4(averageColor, 1.0f - revealage);
+}
@@ -0,0 +1,11 @@
+#version 410 core
+//------------------------------------------------------------------------------------------
+// vertex shader, full screen triangle generated from the vertex index
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+void main()
+{
+    vec2 coord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(coord * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -20,9 +20,12 @@ layout(std140) uniform Material
     float shininess;
 } material;
 
+#ifdef REFLECTION
 uniform samplerCube envTex;
+#endif
+#ifdef OBJECT_TEXTURE
 uniform sampler2D objTex;
-uniform bool hasObjTex;
+#endif
 
 //------------------------------------------------------------------------------------------
 // in variables
@@ -44,34 +47,30 @@ out vec4 fragColor;
 const vec3 ambientLight = vec3(0.2);
 
 //------------------------------------------------------------------------------------------
-// If an object uses texture, it must set "GL_TRUE" to hasObjTex
-// If it use vertex color, it must set material.diffuseColor.x to a number < 0.0f
+// The material features are compiled in by the renderer:
+// OBJECT_TEXTURE samples objTex, MATERIAL_DIFFUSE uses the material diffuse color
+// instead of the vertex color, REFLECTION mixes in the environment map
 //------------------------------------------------------------------------------------------
 void main()
 {
     vec3 normal = normalize(f_normal);
     vec3 lightDir = normalize(f_lightDir);
     vec3 viewDir = normalize(f_viewDir);
-    vec3 reflectionDir = reflect(-viewDir, normal);
 
     float alpha = 1.0f;
     vec3 surfaceColor = vec3(0.0f);
 
-    if(hasObjTex)
-    {
-        vec4 texVal = texture(objTex, f_texcoord);
-        surfaceColor = texVal.xyz;
-        alpha = texVal.w;
-    }
-
-    if(material.diffuseColor.x > -0.001f)
-    {
-        surfaceColor = mix(vec3(material.diffuseColor), surfaceColor, alpha);
-    }
-    else
-    {
-        surfaceColor = mix(f_color, surfaceColor, alpha);
-    }
+#ifdef OBJECT_TEXTURE
+    vec4 texVal = texture(objTex, f_texcoord);
+    surfaceColor = texVal.xyz;
+    alpha = texVal.w;
+#endif
+
+#ifdef MATERIAL_DIFFUSE
+    surfaceColor = mix(vec3(material.diffuseColor), surfaceColor, alpha);
+#else
+    surfaceColor = mix(f_color, surfaceColor, alpha);
+#endif
 
     vec3 ambient = ambientLight * surfaceColor;
     vec3 diffuse = vec3(max(dot(normal, lightDir), 0.0f)) * surfaceColor;
@@ -79,14 +78,16 @@ void main()
     vec3 halfDir = normalize(lightDir + viewDir);
     vec3 specular = pow(max(dot(halfDir, normal), 0.0f), material.shininess) * vec3(material.specularColor);
 
-    vec3 reflection = vec3(0.0f);
-    if(material.reflection > 0.0f)
-    {
-        reflection = texture(envTex, reflectionDir).xyz;
-    }
+    vec3 shadedColor = light.intensity * (ambient + diffuse + specular);
+
+#ifdef REFLECTION
+    vec3 reflectionDir = reflect(-viewDir, normal);
+    vec3 reflection = texture(envTex, reflectionDir).xyz;
+    shadedColor = mix(shadedColor, reflection, material.reflection);
+#endif
 
     /////////////////////////////////////////////////////////////////
     // output
-    fragColor = vec4(mix(light.intensity * (ambient + diffuse + specular), reflection, material.reflection), alpha);
+    fragColor = vec4(shadedColor, alpha);
 
 }
@@ -20,6 +20,7 @@ layout(std140) uniform Light
 } light;
 
 uniform vec3 cameraPosition;
+uniform float texCoordScale;
 
 //------------------------------------------------------------------------------------------
 // in variables
@@ -39,6 +40,24 @@ out VS_OUT
     vec2 f_texcoord;
 };
 
+//------------------------------------------------------------------------------------------
+// compressed vertices store the normal octahedral-encoded in v_normal.xy
+//------------------------------------------------------------------------------------------
+#ifdef OCTAHEDRAL_NORMAL
+vec3 decodeOctahedral(vec2 _encoded)
+{
+    vec3 normal = vec3(_encoded, 1.0 - abs(_encoded.x) - abs(_encoded.y));
+
+    if(normal.z < 0.0)
+    {
+        vec2 signNotZero = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+        normal.xy = (1.0 - abs(normal.yx)) * signNotZero;
+    }
+
+    return normalize(normal);
+}
+#endif
+
 //------------------------------------------------------------------------------------------
 void main()
 {
@@ -47,10 +66,15 @@ void main()
     /////////////////////////////////////////////////////////////////
     // output
     f_color = v_color;
-    f_normal = mat3(normalMatrix) * v_normal;
+#ifdef OCTAHEDRAL_NORMAL
+    vec3 normal = decodeOctahedral(v_normal.xy);
+#else
+    vec3 normal = v_normal;
+#endif
+    f_normal = mat3(normalMatrix) * normal;
     f_lightDir = vec3(light.position) - vec3(worldCoord);
     f_viewDir = vec3(cameraPosition) - vec3(worldCoord);
-    f_texcoord = v_texcoord;
+    f_texcoord = v_texcoord * texCoordScale;
 
 
     gl_Position = viewProjectionMatrix * worldCoord;
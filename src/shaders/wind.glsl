@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------------------
+// wind.glsl
+// Sway of the billboard foliage, spliced into the billboard shaders by the renderer so that
+// all paths bend identically. The renderer bounds the culling radius by WIND_MAX_SWAY,
+// the largest sway factor computed here.
+//------------------------------------------------------------------------------------------
+
+// xy: horizontal wind direction scaled by the strength, z: time in seconds
+uniform vec3 wind;
+
+//------------------------------------------------------------------------------------------
+// value noise of the gust field
+//------------------------------------------------------------------------------------------
+float windHash(vec2 _v)
+{
+    return fract(sin(dot(_v, vec2(127.1f, 311.7f))) * 43758.5453f);
+}
+
+float windNoise(vec2 _v)
+{
+    vec2 cell = floor(_v);
+    vec2 f = fract(_v);
+    f = f * f * (3.0f - 2.0f * f);
+
+    return mix(mix(windHash(cell), windHash(cell + vec2(1.0f, 0.0f)), f.x),
+               mix(windHash(cell + vec2(0.0f, 1.0f)), windHash(cell + vec2(1.0f, 1.0f)), f.x),
+               f.y);
+}
+
+//------------------------------------------------------------------------------------------
+// The gusts are a noise field scrolled along the wind direction, each instance also
+// sways around them with a phase hashed from its position.
+// The bending grows with the squared height over the root, the roots stay planted.
+//------------------------------------------------------------------------------------------
+vec3 windOffset(vec3 _position, float _height)
+{
+    float strength = length(wind.xy);
+
+    if(strength < 1e-6f)
+    {
+        return vec3(0.0f);
+    }
+
+    vec2 direction = wind.xy / strength;
+    float gust = windNoise(0.05f * _position.xz - 0.5f * wind.z * direction);
+    float phase = 6.2831853f * windHash(_position.xz);
+    float sway = gust + 0.3f * sin(1.7f * wind.z + phase);
+
+    vec2 bend = strength * sway * _height * _height * direction;
+
+    return vec3(bend.x, 0.0f, bend.y);
+}
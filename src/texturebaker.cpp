@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------------------
+// texturebaker.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+// Bake textures into the compressed texture cache, so the first launch of the renderer
+// already maps them instead of decoding the sources.
+// Usage: TextureBaker [--mirrored] [file...]
+// Without files, the built-in floor and billboard textures are baked the way the
+// renderer loads them.
+//------------------------------------------------------------------------------------------
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "texturecache.h"
+#include "textureloader.h"
+
+//------------------------------------------------------------------------------------------
+bool bakeTexture(const QString& _fileName, bool _mirrored, QTextStream& _out)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString cachedFile = TextureCache::getCachedFileName(_fileName, _mirrored);
+    QImage image = TextureLoader::decodeImage(_fileName, _mirrored);
+
+    if(cachedFile.isEmpty() || image.isNull() || !TextureCache::bake(image, cachedFile))
+    {
+        _out << "Failed: " << _fileName << "\n";
+        return false;
+    }
+
+    _out << _fileName << " -> " << cachedFile << " ("
+         << (double)timer.nsecsElapsed() * 1e-6 << " ms)" << "\n";
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList arguments = app.arguments().mid(1);
+    bool mirrored = arguments.removeAll("--mirrored") > 0;
+    bool success = true;
+
+    if(arguments.isEmpty())
+    {
+        success &= bakeTexture(":/textures/checkerboard.jpg", true, out);
+
+        QDir billboardDir(":/textures/billboards", "*.png", QDir::Name, QDir::Files);
+
+        for(const QString& textureFile : billboardDir.entryList())
+        {
+            success &= bakeTexture(billboardDir.filePath(textureFile), false, out);
+        }
+    }
+    else
+    {
+        for(const QString& fileName : arguments)
+        {
+            success &= bakeTexture(fileName, mirrored, out);
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,451 @@
+//------------------------------------------------------------------------------------------
+// texturecache.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include "texturecache.h"
+
+#define KTX_HEADER_SIZE 64
+#define KTX_ENDIANNESS 0x04030201
+#define BLOCK_SIZE 4
+
+static const quint8 KTX_IDENTIFIER[12] =
+{
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+//------------------------------------------------------------------------------------------
+static quint16 packRGB565(const int _color[3])
+{
+    return (quint16)(((_color[0] >> 3) << 11) | ((_color[1] >> 2) << 5) | (_color[2] >> 3));
+}
+
+//------------------------------------------------------------------------------------------
+static void unpackRGB565(quint16 _packed, int _color[3])
+{
+    int r = (_packed >> 11) & 31;
+    int g = (_packed >> 5) & 63;
+    int b = _packed & 31;
+
+    _color[0] = (r << 3) | (r >> 2);
+    _color[1] = (g << 2) | (g >> 4);
+    _color[2] = (b << 3) | (b >> 2);
+}
+
+//------------------------------------------------------------------------------------------
+static void appendUInt32(QByteArray& _data, quint32 _value)
+{
+    quint32 littleEndian = qToLittleEndian(_value);
+    _data.append(reinterpret_cast<const char*>(&littleEndian), sizeof(quint32));
+}
+
+//------------------------------------------------------------------------------------------
+CompressedTexture::CompressedTexture():
+    mappedData(NULL),
+    internalFormat(0),
+    width(0),
+    height(0)
+{
+}
+
+//------------------------------------------------------------------------------------------
+CompressedTexture::~CompressedTexture()
+{
+    if(mappedData)
+    {
+        file.unmap(mappedData);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+bool CompressedTexture::load(const QString& _ktxFile)
+{
+    file.setFileName(_ktxFile);
+
+    if(!file.open(QIODevice::ReadOnly) || file.size() < KTX_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    mappedData = file.map(0, file.size());
+
+    if(!mappedData)
+    {
+        return false;
+    }
+
+    const quint32* header = reinterpret_cast<const quint32*>(mappedData + 12);
+
+    if(memcmp(mappedData, KTX_IDENTIFIER, 12) != 0 ||
+       qFromLittleEndian(header[0]) != KTX_ENDIANNESS)
+    {
+        qDebug() << "Invalid KTX file:" << _ktxFile;
+        return false;
+    }
+
+    internalFormat = qFromLittleEndian(header[4]);
+    width = qFromLittleEndian(header[6]);
+    height = qFromLittleEndian(header[7]);
+
+    int numMipLevels = qFromLittleEndian(header[11]);
+    int offset = KTX_HEADER_SIZE + qFromLittleEndian(header[12]);
+
+    for(int level = 0; level < numMipLevels; ++level)
+    {
+        if(offset + (int)sizeof(quint32) > file.size())
+        {
+            return false;
+        }
+
+        int imageSize = qFromLittleEndian(*reinterpret_cast<const quint32*>(mappedData + offset));
+        offset += sizeof(quint32);
+
+        if(offset + imageSize > file.size())
+        {
+            return false;
+        }
+
+        mipLevelOffsets.append(offset);
+        mipLevelSizes.append(imageSize);
+        offset += (imageSize + 3) & ~3;
+    }
+
+    return numMipLevels > 0;
+}
+
+//------------------------------------------------------------------------------------------
+GLenum CompressedTexture::getInternalFormat() const
+{
+    return internalFormat;
+}
+
+//------------------------------------------------------------------------------------------
+int CompressedTexture::getWidth() const
+{
+    return width;
+}
+
+//------------------------------------------------------------------------------------------
+int CompressedTexture::getHeight() const
+{
+    return height;
+}
+
+//------------------------------------------------------------------------------------------
+int CompressedTexture::getNumMipLevels() const
+{
+    return mipLevelOffsets.size();
+}
+
+//------------------------------------------------------------------------------------------
+const uchar* CompressedTexture::getMipLevelData(int _level) const
+{
+    return mappedData + mipLevelOffsets[_level];
+}
+
+//------------------------------------------------------------------------------------------
+int CompressedTexture::getMipLevelDataSize(int _level) const
+{
+    return mipLevelSizes[_level];
+}
+
+//------------------------------------------------------------------------------------------
+QString TextureCache::getCacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           "/TextureBillboard/textures";
+}
+
+//------------------------------------------------------------------------------------------
+QString TextureCache::getCachedFileName(const QString& _sourceFile, bool _mirrored)
+{
+    QFile sourceFile(_sourceFile);
+
+    if(!sourceFile.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&sourceFile);
+    hash.addData(QString("mirrored=%1,version=%2").arg(_mirrored).arg(
+                     TEXTURE_CACHE_VERSION).toUtf8());
+
+    return QString("%1/%2.ktx").arg(getCacheDirectory()).arg(QString(hash.result().toHex()));
+}
+
+//------------------------------------------------------------------------------------------
+// the mip chain is built by halving the image down to 1x1, then each level is compressed.
+// The file is written under a temporary name and renamed, so that a concurrent reader
+// never maps a partially written file.
+//------------------------------------------------------------------------------------------
+bool TextureCache::bake(const QImage& _image, const QString& _ktxFile)
+{
+    QImage image = _image.convertToFormat(QImage::Format_RGBA8888);
+    bool hasAlpha = false;
+
+    for(int y = 0; y < image.height() && !hasAlpha; ++y)
+    {
+        const quint8* scanline = image.constScanLine(y);
+
+        for(int x = 0; x < image.width(); ++x)
+        {
+            if(scanline[4 * x + 3] != 255)
+            {
+                hasAlpha = true;
+                break;
+            }
+        }
+    }
+
+    QVector<QByteArray> mipLevels;
+
+    while(true)
+    {
+        mipLevels.append(compressImage(image, hasAlpha));
+
+        if(image.width() == 1 && image.height() == 1)
+        {
+            break;
+        }
+
+        image = image.scaled(std::max(1, image.width() / 2), std::max(1, image.height() / 2),
+                             Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // KTX header
+    QByteArray data(reinterpret_cast<const char*>(KTX_IDENTIFIER), 12);
+    appendUInt32(data, KTX_ENDIANNESS);
+    appendUInt32(data, 0);                                       // glType
+    appendUInt32(data, 1);                                       // glTypeSize
+    appendUInt32(data, 0);                                       // glFormat
+    appendUInt32(data, hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT :
+                 GL_COMPRESSED_RGB_S3TC_DXT1_EXT);               // glInternalFormat
+    appendUInt32(data, hasAlpha ? GL_RGBA : GL_RGB);             // glBaseInternalFormat
+    appendUInt32(data, _image.width());
+    appendUInt32(data, _image.height());
+    appendUInt32(data, 0);                                       // pixelDepth
+    appendUInt32(data, 0);                                       // numberOfArrayElements
+    appendUInt32(data, 1);                                       // numberOfFaces
+    appendUInt32(data, mipLevels.size());
+    appendUInt32(data, 0);                                       // bytesOfKeyValueData
+
+    // compressed blocks are 8 or 16 bytes, no mip padding is needed
+    for(const QByteArray& mipLevel : mipLevels)
+    {
+        appendUInt32(data, mipLevel.size());
+        data.append(mipLevel);
+    }
+
+    /////////////////////////////////////////////////////////////////
+    QDir().mkpath(QFileInfo(_ktxFile).absolutePath());
+
+    QString tmpFileName = _ktxFile + ".tmp";
+    QFile tmpFile(tmpFileName);
+
+    if(!tmpFile.open(QIODevice::WriteOnly) || tmpFile.write(data) != data.size())
+    {
+        qDebug() << "Cannot write texture cache file:" << tmpFileName;
+        return false;
+    }
+
+    tmpFile.close();
+    QFile::remove(_ktxFile);
+
+    return QFile::rename(tmpFileName, _ktxFile);
+}
+
+//------------------------------------------------------------------------------------------
+// the border blocks of images not multiple of 4 repeat the last row/column
+//------------------------------------------------------------------------------------------
+QByteArray TextureCache::compressImage(const QImage& _image, bool _hasAlpha)
+{
+    const int numBlocksX = (_image.width() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int numBlocksY = (_image.height() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const int blockBytes = _hasAlpha ? 16 : 8;
+
+    QByteArray compressed(numBlocksX * numBlocksY * blockBytes, 0);
+    quint8* output = reinterpret_cast<quint8*>(compressed.data());
+    quint8 block[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+    for(int by = 0; by < numBlocksY; ++by)
+    {
+        for(int bx = 0; bx < numBlocksX; ++bx)
+        {
+            for(int py = 0; py < BLOCK_SIZE; ++py)
+            {
+                int y = std::min(by * BLOCK_SIZE + py, _image.height() - 1);
+                const quint8* scanline = _image.constScanLine(y);
+
+                for(int px = 0; px < BLOCK_SIZE; ++px)
+                {
+                    int x = std::min(bx * BLOCK_SIZE + px, _image.width() - 1);
+                    memcpy(&block[4 * (py * BLOCK_SIZE + px)], &scanline[4 * x], 4);
+                }
+            }
+
+            if(_hasAlpha)
+            {
+                compressAlphaBlock(block, output);
+                output += 8;
+            }
+
+            compressColorBlock(block, output);
+            output += 8;
+        }
+    }
+
+    return compressed;
+}
+
+//------------------------------------------------------------------------------------------
+// BC1 color block: the end points are the inset bounding box of the block colors
+// (van Waveren 2006), each texel takes the closest of the 4 palette colors
+//------------------------------------------------------------------------------------------
+void TextureCache::compressColorBlock(const quint8* _block, quint8* _output)
+{
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+
+    for(int i = 0; i < 16; ++i)
+    {
+        for(int c = 0; c < 3; ++c)
+        {
+            minColor[c] = std::min(minColor[c], (int)_block[4 * i + c]);
+            maxColor[c] = std::max(maxColor[c], (int)_block[4 * i + c]);
+        }
+    }
+
+    for(int c = 0; c < 3; ++c)
+    {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+
+    // color0 > color1 selects the 4 color mode
+    quint16 color0 = packRGB565(maxColor);
+    quint16 color1 = packRGB565(minColor);
+
+    if(color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    int palette[4][3];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+
+    for(int c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    quint32 indices = 0;
+
+    if(color0 != color1)
+    {
+        for(int i = 0; i < 16; ++i)
+        {
+            int bestIndex = 0;
+            int bestDistance = INT_MAX;
+
+            for(int p = 0; p < 4; ++p)
+            {
+                int distance = 0;
+
+                for(int c = 0; c < 3; ++c)
+                {
+                    int diff = (int)_block[4 * i + c] - palette[p][c];
+                    distance += diff * diff;
+                }
+
+                if(distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+
+            indices |= (quint32)bestIndex << (2 * i);
+        }
+    }
+
+    qToLittleEndian(color0, _output);
+    qToLittleEndian(color1, _output + 2);
+    qToLittleEndian(indices, _output + 4);
+}
+
+//------------------------------------------------------------------------------------------
+// BC3 alpha block: the end points are the alpha range of the block,
+// interpolated into 8 values with 3 bit indices
+//------------------------------------------------------------------------------------------
+void TextureCache::compressAlphaBlock(const quint8* _block, quint8* _output)
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+
+    for(int i = 0; i < 16; ++i)
+    {
+        minAlpha = std::min(minAlpha, (int)_block[4 * i + 3]);
+        maxAlpha = std::max(maxAlpha, (int)_block[4 * i + 3]);
+    }
+
+    int palette[8];
+    palette[0] = maxAlpha;
+    palette[1] = minAlpha;
+
+    for(int k = 1; k < 7; ++k)
+    {
+        palette[k + 1] = ((7 - k) * maxAlpha + k * minAlpha) / 7;
+    }
+
+    quint64 indices = 0;
+
+    if(maxAlpha > minAlpha)
+    {
+        for(int i = 0; i < 16; ++i)
+        {
+            int bestIndex = 0;
+            int bestDistance = INT_MAX;
+
+            for(int p = 0; p < 8; ++p)
+            {
+                int distance = abs((int)_block[4 * i + 3] - palette[p]);
+
+                if(distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+
+            indices |= (quint64)bestIndex << (3 * i);
+        }
+    }
+
+    _output[0] = (quint8)maxAlpha;
+    _output[1] = (quint8)minAlpha;
+
+    for(int b = 0; b < 6; ++b)
+    {
+        _output[2 + b] = (quint8)((indices >> (8 * b)) & 0xFF);
+    }
+}
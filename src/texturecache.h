@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------------------
+// texturecache.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <qopengl.h>
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#define TEXTURE_CACHE_VERSION 1
+
+//------------------------------------------------------------------------------------------
+// A KTX (version 1) file of a compressed texture with its full mip chain.
+// The file is memory-mapped, the mip levels point directly into the mapping
+// and are valid as long as the object lives.
+//------------------------------------------------------------------------------------------
+class CompressedTexture
+{
+public:
+    CompressedTexture();
+    ~CompressedTexture();
+
+    bool load(const QString& _ktxFile);
+
+    GLenum getInternalFormat() const;
+    int getWidth() const;
+    int getHeight() const;
+    int getNumMipLevels() const;
+    const uchar* getMipLevelData(int _level) const;
+    int getMipLevelDataSize(int _level) const;
+
+private:
+    QFile file;
+    uchar* mappedData;
+    GLenum internalFormat;
+    int width;
+    int height;
+    QVector<int> mipLevelOffsets;
+    QVector<int> mipLevelSizes;
+};
+
+//------------------------------------------------------------------------------------------
+// On-disk cache of BC1/BC3 (S3TC) compressed textures.
+// A cached file is named after the hash of the source file content and of the way it is
+// loaded, so editing a source image invalidates its cache entry.
+// Images without transparent texels are compressed to BC1, the others to BC3.
+//------------------------------------------------------------------------------------------
+class TextureCache
+{
+public:
+    static QString getCacheDirectory();
+    static QString getCachedFileName(const QString& _sourceFile, bool _mirrored);
+
+    static bool bake(const QImage& _image, const QString& _ktxFile);
+
+private:
+    static QByteArray compressImage(const QImage& _image, bool _hasAlpha);
+    static void compressColorBlock(const quint8* _block, quint8* _output);
+    static void compressAlphaBlock(const quint8* _block, quint8* _output);
+};
+
+#endif // TEXTURECACHE_H
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------------------
+// textureloader.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QtConcurrent>
+#include <QDebug>
+
+#include "textureloader.h"
+
+//------------------------------------------------------------------------------------------
+TextureLoader::~TextureLoader()
+{
+    waitForAll();
+
+    for(QFuture<bool>& future : bakeFutures)
+    {
+        future.waitForFinished();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+int TextureLoader::requestTexture(const QString& _fileName, bool _mirrored, bool _useCache)
+{
+    futures.append(QtConcurrent::run(&TextureLoader::loadTexture, _fileName, _mirrored,
+                                     _useCache));
+
+    return futures.size() - 1;
+}
+
+//------------------------------------------------------------------------------------------
+bool TextureLoader::isReady(int _request) const
+{
+    return futures[_request].isFinished();
+}
+
+//------------------------------------------------------------------------------------------
+// the future is dropped after its texture is taken, so the decoded pixels are not kept twice.
+// A cache miss is baked from the shared image while the caller uploads it.
+//------------------------------------------------------------------------------------------
+LoadedTexture TextureLoader::takeTexture(int _request)
+{
+    LoadedTexture texture = futures[_request].result();
+    futures[_request] = QFuture<LoadedTexture>();
+
+    if(!texture.image.isNull() && !texture.cachedFile.isEmpty())
+    {
+        bakeFutures.append(QtConcurrent::run(&TextureCache::bake, texture.image,
+                                             texture.cachedFile));
+    }
+
+    return texture;
+}
+
+//------------------------------------------------------------------------------------------
+void TextureLoader::waitForAll()
+{
+    for(QFuture<LoadedTexture>& future : futures)
+    {
+        future.waitForFinished();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+QImage TextureLoader::decodeImage(const QString& _fileName, bool _mirrored)
+{
+    QImage image(_fileName);
+
+    if(image.isNull())
+    {
+        qDebug() << "Cannot load texture from file:" << _fileName;
+
+        return image;
+    }
+
+    if(_mirrored)
+    {
+        image = image.mirrored();
+    }
+
+    return image.convertToFormat(QImage::Format_RGBA8888);
+}
+
+//------------------------------------------------------------------------------------------
+LoadedTexture TextureLoader::loadTexture(const QString& _fileName, bool _mirrored,
+                                         bool _useCache)
+{
+    LoadedTexture texture;
+    texture.fileName = _fileName;
+    texture.mirrored = _mirrored;
+
+    if(_useCache)
+    {
+        QString cachedFile = TextureCache::getCachedFileName(_fileName, _mirrored);
+        QSharedPointer<CompressedTexture> compressed(new CompressedTexture);
+
+        if(!cachedFile.isEmpty() && QFile::exists(cachedFile) && compressed->load(cachedFile))
+        {
+            texture.compressed = compressed;
+            return texture;
+        }
+
+        texture.image = decodeImage(_fileName, _mirrored);
+        texture.cachedFile = cachedFile;
+
+        return texture;
+    }
+
+    texture.image = decodeImage(_fileName, _mirrored);
+
+    return texture;
+}
@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------------------
+// textureloader.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <QFuture>
+#include <QImage>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include "texturecache.h"
+
+//------------------------------------------------------------------------------------------
+// result of a texture request: the compressed texture from the cache when it is used,
+// otherwise the decoded image. A decoded image missing from the cache keeps the name
+// of the cache file it is baked into.
+//------------------------------------------------------------------------------------------
+struct LoadedTexture
+{
+    QString fileName;
+    bool mirrored;
+    QImage image;
+    QSharedPointer<CompressedTexture> compressed;
+    QString cachedFile;
+};
+
+//------------------------------------------------------------------------------------------
+// Decodes texture images on the global thread pool, so the decoding time scales with
+// the number of cores instead of stalling the first frame.
+// The decoded images are converted to RGBA8888 and are ready for a pixel buffer upload,
+// which the renderer does on its own context when isReady() returns true.
+// With the compressed cache, a cached file is memory-mapped instead of decoding the source.
+// A missing one is baked in a separate background task once the decoded image is taken,
+// so a cold start uploads the image right away and the next launches use the cache.
+//------------------------------------------------------------------------------------------
+class TextureLoader
+{
+public:
+    ~TextureLoader();
+
+    int requestTexture(const QString& _fileName, bool _mirrored, bool _useCache);
+    bool isReady(int _request) const;
+    LoadedTexture takeTexture(int _request);
+
+    void waitForAll();
+
+    static QImage decodeImage(const QString& _fileName, bool _mirrored);
+
+private:
+    static LoadedTexture loadTexture(const QString& _fileName, bool _mirrored, bool _useCache);
+
+    QVector<QFuture<LoadedTexture> > futures;
+    QVector<QFuture<bool> > bakeFutures;
+};
+
+#endif // TEXTURELOADER_H
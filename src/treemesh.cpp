@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------------------
+// treemesh.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <cmath>
+
+#include "treemesh.h"
+
+//------------------------------------------------------------------------------------------
+// a trunk under stacked foliage cones, darker toward the ground
+//------------------------------------------------------------------------------------------
+TreeMesh::TreeMesh()
+{
+    addCone(-1.0f, -0.35f, 0.1f, 0.07f, QVector3D(0.35f, 0.22f, 0.12f));
+
+    for(int i = 0; i < TREE_NUM_FOLIAGE_CONES; ++i)
+    {
+        float t = (float)i / (float)TREE_NUM_FOLIAGE_CONES;
+        float bottom = -0.55f + 1.1f * t;
+        float shade = 0.8f + 0.4f * t;
+
+        addCone(bottom, bottom + 0.8f, 0.75f - 0.35f * t, 0.0f,
+                shade * QVector3D(0.18f, 0.45f, 0.15f));
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// side of a truncated cone around the y axis, with its bottom cap
+//------------------------------------------------------------------------------------------
+void TreeMesh::addCone(float _bottom, float _top, float _bottomRadius, float _topRadius,
+                       const QVector3D& _color)
+{
+    GLushort firstVertex = (GLushort)getNumVertices();
+    float slope = (_bottomRadius - _topRadius) / (_top - _bottom);
+
+    for(int i = 0; i <= TREE_NUM_SEGMENTS; ++i)
+    {
+        float angle = 2.0f * (float)M_PI * (float)i / (float)TREE_NUM_SEGMENTS;
+        float c = cos(angle);
+        float s = sin(angle);
+        QVector3D normal = QVector3D(c, slope, s).normalized();
+
+        addVertex(QVector3D(_bottomRadius * c, _bottom, _bottomRadius * s), normal, _color);
+        addVertex(QVector3D(_topRadius * c, _top, _topRadius * s), normal, _color);
+    }
+
+    for(int i = 0; i < TREE_NUM_SEGMENTS; ++i)
+    {
+        GLushort v = (GLushort)(firstVertex + 2 * i);
+
+        indices << v << (GLushort)(v + 1) << (GLushort)(v + 3);
+        indices << (GLushort)(v + 3) << (GLushort)(v + 2) << v;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    // bottom cap, a fan around its center
+    GLushort center = (GLushort)getNumVertices();
+    addVertex(QVector3D(0.0f, _bottom, 0.0f), QVector3D(0.0f, -1.0f, 0.0f), _color);
+
+    for(int i = 0; i < TREE_NUM_SEGMENTS; ++i)
+    {
+        float angle = 2.0f * (float)M_PI * (float)i / (float)TREE_NUM_SEGMENTS;
+        addVertex(QVector3D(_bottomRadius * cos(angle), _bottom, _bottomRadius * sin(angle)),
+                  QVector3D(0.0f, -1.0f, 0.0f), _color);
+    }
+
+    for(int i = 0; i < TREE_NUM_SEGMENTS; ++i)
+    {
+        indices << center << (GLushort)(center + 1 + (i + 1) % TREE_NUM_SEGMENTS)
+                << (GLushort)(center + 1 + i);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void TreeMesh::addVertex(const QVector3D& _position, const QVector3D& _normal,
+                         const QVector3D& _color)
+{
+    vertices << _position.x() << _position.y() << _position.z();
+    vertices << _normal.x() << _normal.y() << _normal.z();
+    vertices << _color.x() << _color.y() << _color.z();
+}
+
+//------------------------------------------------------------------------------------------
+int TreeMesh::getNumVertices() const
+{
+    return vertices.size() / 9;
+}
+
+//------------------------------------------------------------------------------------------
+int TreeMesh::getNumIndices() const
+{
+    return indices.size();
+}
+
+//------------------------------------------------------------------------------------------
+const QVector<GLfloat>& TreeMesh::getVertices() const
+{
+    return vertices;
+}
+
+//------------------------------------------------------------------------------------------
+const QVector<GLushort>& TreeMesh::getIndices() const
+{
+    return indices;
+}
+
+//------------------------------------------------------------------------------------------
+int TreeMesh::getStride()
+{
+    return 9 * sizeof(GLfloat);
+}
+
+//------------------------------------------------------------------------------------------
+int TreeMesh::getNormalOffset()
+{
+    return 3 * sizeof(GLfloat);
+}
+
+//------------------------------------------------------------------------------------------
+int TreeMesh::getColorOffset()
+{
+    return 6 * sizeof(GLfloat);
+}
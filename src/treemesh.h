@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------------------
+// treemesh.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef TREEMESH_H
+#define TREEMESH_H
+
+#include <QOpenGLFunctions_4_0_Core>
+#include <QVector>
+#include <QVector3D>
+
+#define TREE_NUM_SEGMENTS 12
+#define TREE_NUM_FOLIAGE_CONES 3
+
+//------------------------------------------------------------------------------------------
+// Low-poly tree, the full-detail level of the billboard LOD.
+// It fits the billboard quad: the unit box [-1, 1]^3 with the ground at y = -1,
+// so an instance is placed by the same position and scale as its billboard.
+// Vertices are interleaved float position, normal and color.
+//------------------------------------------------------------------------------------------
+class TreeMesh
+{
+public:
+    TreeMesh();
+
+    int getNumVertices() const;
+    int getNumIndices() const;
+    const QVector<GLfloat>& getVertices() const;
+    const QVector<GLushort>& getIndices() const;
+
+    static int getStride();
+    static int getNormalOffset();
+    static int getColorOffset();
+
+private:
+    void addCone(float _bottom, float _top, float _bottomRadius, float _topRadius,
+                 const QVector3D& _color);
+    void addVertex(const QVector3D& _position, const QVector3D& _normal,
+                   const QVector3D& _color);
+
+    QVector<GLfloat> vertices;
+    QVector<GLushort> indices;
+};
+
+#endif // TREEMESH_H
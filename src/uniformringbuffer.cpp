@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------------------
+// uniformringbuffer.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <cstring>
+#include <QDebug>
+
+#include "uniformringbuffer.h"
+
+#define FENCE_TIMEOUT_NS 1000000000
+
+//------------------------------------------------------------------------------------------
+UniformRingBuffer::UniformRingBuffer():
+    gl(NULL),
+    buffer(0),
+    offsetAlignment(256),
+    frameSize(0),
+    numFrames(0),
+    currentFrame(0),
+    frameOffset(0)
+{
+}
+
+//------------------------------------------------------------------------------------------
+void UniformRingBuffer::create(QOpenGLFunctions_4_0_Core* _gl, int _blockSize,
+                               int _blocksPerFrame, int _numFrames)
+{
+    gl = _gl;
+    gl->glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+
+    frameSize = alignSize(_blockSize) * _blocksPerFrame;
+    numFrames = _numFrames;
+    currentFrame = 0;
+    frameOffset = 0;
+    stagingData.resize(frameSize);
+    fences.fill(0, numFrames);
+
+    gl->glGenBuffers(1, &buffer);
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    gl->glBufferData(GL_UNIFORM_BUFFER, frameSize * numFrames, NULL, GL_STREAM_DRAW);
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//------------------------------------------------------------------------------------------
+// the region of this frame was last used numFrames frames ago,
+// the fence only blocks when the GPU is that far behind
+//------------------------------------------------------------------------------------------
+void UniformRingBuffer::beginFrame()
+{
+    currentFrame = (currentFrame + 1) % numFrames;
+    frameOffset = 0;
+
+    if(fences[currentFrame])
+    {
+        gl->glClientWaitSync(fences[currentFrame], GL_SYNC_FLUSH_COMMANDS_BIT,
+                             FENCE_TIMEOUT_NS);
+        gl->glDeleteSync(fences[currentFrame]);
+        fences[currentFrame] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void UniformRingBuffer::endFrame()
+{
+    fences[currentFrame] = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+//------------------------------------------------------------------------------------------
+// copy a uniform block into the staging memory of the frame, return its offset
+// from the start of the frame region
+//------------------------------------------------------------------------------------------
+GLintptr UniformRingBuffer::allocate(const void* _data, int _size)
+{
+    int alignedSize = alignSize(_size);
+
+    if(frameOffset + alignedSize > stagingData.size())
+    {
+        stagingData.resize(qMax(2 * stagingData.size(), frameOffset + alignedSize));
+    }
+
+    GLintptr offset = frameOffset;
+    memcpy(stagingData.data() + frameOffset, _data, _size);
+    frameOffset += alignedSize;
+
+    return offset;
+}
+
+//------------------------------------------------------------------------------------------
+// Upload the staged blocks into the frame region with one mapping. The region is free
+// since its fence was waited for, the mapping does not need to synchronize.
+// If the buffer cannot be mapped, the blocks are uploaded with glBufferSubData instead,
+// so that the draws never read stale blocks.
+//------------------------------------------------------------------------------------------
+void UniformRingBuffer::flush()
+{
+    if(frameOffset == 0)
+    {
+        return;
+    }
+
+    if(frameOffset > frameSize)
+    {
+        grow(frameOffset);
+    }
+
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    void* regionData = gl->glMapBufferRange(GL_UNIFORM_BUFFER, getFrameOffset(), frameOffset,
+                                            GL_MAP_WRITE_BIT |
+                                            GL_MAP_INVALIDATE_RANGE_BIT |
+                                            GL_MAP_UNSYNCHRONIZED_BIT);
+    bool uploaded = false;
+
+    if(regionData)
+    {
+        memcpy(regionData, stagingData.constData(), frameOffset);
+        uploaded = (gl->glUnmapBuffer(GL_UNIFORM_BUFFER) == GL_TRUE);
+    }
+
+    if(!uploaded)
+    {
+        qWarning() << "Cannot map the uniform ring buffer, uploading the frame blocks with"
+                   << "glBufferSubData.";
+        gl->glBufferSubData(GL_UNIFORM_BUFFER, getFrameOffset(), frameOffset,
+                            stagingData.constData());
+    }
+
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//------------------------------------------------------------------------------------------
+GLintptr UniformRingBuffer::getFrameOffset() const
+{
+    return (GLintptr)currentFrame * frameSize;
+}
+
+//------------------------------------------------------------------------------------------
+GLuint UniformRingBuffer::getBufferId() const
+{
+    return buffer;
+}
+
+//------------------------------------------------------------------------------------------
+int UniformRingBuffer::alignSize(int _size) const
+{
+    return (_size + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+}
+
+//------------------------------------------------------------------------------------------
+// The regions are doubled until the current frame fits, the new storage orphans the old
+// one: the draws in flight keep it, all regions are free again.
+// The staged blocks keep their offsets from the start of the frame region.
+//------------------------------------------------------------------------------------------
+void UniformRingBuffer::grow(int _minFrameSize)
+{
+    while(frameSize < _minFrameSize)
+    {
+        frameSize *= 2;
+    }
+
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    gl->glBufferData(GL_UNIFORM_BUFFER, frameSize * numFrames, NULL, GL_STREAM_DRAW);
+    gl->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    for(GLsync& fence : fences)
+    {
+        if(fence)
+        {
+            gl->glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+//------------------------------------------------------------------------------------------
+// uniformringbuffer.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef UNIFORMRINGBUFFER_H
+#define UNIFORMRINGBUFFER_H
+
+#include <QByteArray>
+#include <QOpenGLFunctions_4_0_Core>
+#include <QVector>
+
+//------------------------------------------------------------------------------------------
+// One large uniform buffer split into a region per frame in flight.
+// The uniform blocks of a frame are staged in CPU memory, then flush() copies them into
+// the region of the current frame through a single unsynchronized mapping, before the draws
+// bind them with glBindBufferRange at getFrameOffset() + their block offset.
+// A fence placed at the end of the frame guards the region before it is written again,
+// so the driver never has to synchronize the buffer with the draws still in flight.
+// The regions are sized for an expected number of blocks per frame; a frame staging more
+// doubles them once, the following frames run without overflow.
+//------------------------------------------------------------------------------------------
+class UniformRingBuffer
+{
+public:
+    UniformRingBuffer();
+
+    void create(QOpenGLFunctions_4_0_Core* _gl, int _blockSize, int _blocksPerFrame,
+                int _numFrames);
+
+    void beginFrame();
+    void endFrame();
+
+    // offset of the staged block from the start of the frame region
+    GLintptr allocate(const void* _data, int _size);
+    void flush();
+
+    GLintptr getFrameOffset() const;
+    GLuint getBufferId() const;
+
+private:
+    int alignSize(int _size) const;
+    void grow(int _minFrameSize);
+
+    QOpenGLFunctions_4_0_Core* gl;
+    GLuint buffer;
+    GLint offsetAlignment;
+    int frameSize;
+    int numFrames;
+    int currentFrame;
+    int frameOffset;
+    QByteArray stagingData;
+    QVector<GLsync> fences;
+};
+
+#endif // UNIFORMRINGBUFFER_H
@@ -170,6 +170,21 @@ GLushort* UnitPlane::getIndices()
     return indices;
 }
 
+//------------------------------------------------------------------------------------------
+QByteArray UnitPlane::getInterleavedVertices(const VertexFormat& _format) const
+{
+    QByteArray interleaved(vertexList.size() * _format.getStride(), 0);
+    uchar* vertex = reinterpret_cast<uchar*>(interleaved.data());
+
+    for(int i = 0; i < vertexList.size(); ++i)
+    {
+        _format.writeVertex(vertexList.at(i), normalsList.at(i), texCoordList.at(i), vertex);
+        vertex += _format.getStride();
+    }
+
+    return interleaved;
+}
+
 //------------------------------------------------------------------------------------------
 void UnitPlane::clearData()
 {
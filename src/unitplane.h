@@ -10,6 +10,8 @@
 #include <QVector3D>
 #include <QVector2D>
 
+#include "vertexformat.h"
+
 #ifndef UNITPLANE_H
 #define UNITPLANE_H
 
@@ -33,6 +35,9 @@ public:
     GLfloat* getTexureCoordinates(float _scale);
     GLushort* getIndices();
 
+    // position, normal and texture coordinates interleaved with the given format
+    QByteArray getInterleavedVertices(const VertexFormat& _format) const;
+
 
 private:
     void clearData();
@@ -0,0 +1,194 @@
+//------------------------------------------------------------------------------------------
+// vertexformat.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstring>
+
+#include "vertexformat.h"
+
+//------------------------------------------------------------------------------------------
+VertexFormat::VertexFormat(VertexEncoding _encoding):
+    encoding(_encoding)
+{
+    if(encoding == COMPRESSED_VERTICES)
+    {
+        setAttribute(VERTEX_POSITION, GL_HALF_FLOAT, 3, GL_FALSE, 0);
+        setAttribute(VERTEX_NORMAL, GL_SHORT, 2, GL_TRUE, 4 * sizeof(GLushort));
+        setAttribute(VERTEX_TEXCOORD, GL_UNSIGNED_SHORT, 2, GL_TRUE, 6 * sizeof(GLushort));
+        stride = 8 * sizeof(GLushort);
+    }
+    else
+    {
+        setAttribute(VERTEX_POSITION, GL_FLOAT, 3, GL_FALSE, 0);
+        setAttribute(VERTEX_NORMAL, GL_FLOAT, 3, GL_FALSE, 3 * sizeof(GLfloat));
+        setAttribute(VERTEX_TEXCOORD, GL_FLOAT, 2, GL_FALSE, 6 * sizeof(GLfloat));
+        stride = 8 * sizeof(GLfloat);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void VertexFormat::setAttribute(VertexAttribute _attribute, GLenum _type, GLint _tupleSize,
+                                GLboolean _normalized, int _offset)
+{
+    attributes[_attribute].type = _type;
+    attributes[_attribute].tupleSize = _tupleSize;
+    attributes[_attribute].normalized = _normalized;
+    attributes[_attribute].offset = _offset;
+}
+
+//------------------------------------------------------------------------------------------
+VertexEncoding VertexFormat::getEncoding() const
+{
+    return encoding;
+}
+
+//------------------------------------------------------------------------------------------
+int VertexFormat::getStride() const
+{
+    return stride;
+}
+
+//------------------------------------------------------------------------------------------
+bool VertexFormat::hasOctahedralNormals() const
+{
+    return (encoding == COMPRESSED_VERTICES);
+}
+
+//------------------------------------------------------------------------------------------
+const VertexAttributeFormat& VertexFormat::getAttribute(VertexAttribute _attribute) const
+{
+    return attributes[_attribute];
+}
+
+//------------------------------------------------------------------------------------------
+void VertexFormat::setupAttribute(QOpenGLFunctions_4_0_Core* _gl, GLuint _location,
+                                  VertexAttribute _attribute) const
+{
+    const VertexAttributeFormat& format = attributes[_attribute];
+
+    _gl->glEnableVertexAttribArray(_location);
+    _gl->glVertexAttribPointer(_location, format.tupleSize, format.type, format.normalized,
+                               stride, reinterpret_cast<const void*>((qintptr)format.offset));
+}
+
+//------------------------------------------------------------------------------------------
+void VertexFormat::writeVertex(const QVector3D& _position, const QVector3D& _normal,
+                               const QVector2D& _texCoord, uchar* _vertex) const
+{
+    if(encoding == COMPRESSED_VERTICES)
+    {
+        QVector2D octahedral = encodeOctahedral(_normal);
+        GLushort position[4] = {floatToHalf(_position.x()), floatToHalf(_position.y()),
+                                floatToHalf(_position.z()), floatToHalf(1.0f)
+                               };
+        GLshort normal[2] =
+        {
+            (GLshort)lround(qBound(-1.0f, octahedral.x(), 1.0f) * 32767.0f),
+            (GLshort)lround(qBound(-1.0f, octahedral.y(), 1.0f) * 32767.0f)
+        };
+        GLushort texCoord[2] =
+        {
+            (GLushort)lround(qBound(0.0f, _texCoord.x(), 1.0f) * 65535.0f),
+            (GLushort)lround(qBound(0.0f, _texCoord.y(), 1.0f) * 65535.0f)
+        };
+
+        memcpy(_vertex + attributes[VERTEX_POSITION].offset, position, sizeof(position));
+        memcpy(_vertex + attributes[VERTEX_NORMAL].offset, normal, sizeof(normal));
+        memcpy(_vertex + attributes[VERTEX_TEXCOORD].offset, texCoord, sizeof(texCoord));
+    }
+    else
+    {
+        GLfloat position[3] = {_position.x(), _position.y(), _position.z()};
+        GLfloat normal[3] = {_normal.x(), _normal.y(), _normal.z()};
+        GLfloat texCoord[2] = {_texCoord.x(), _texCoord.y()};
+
+        memcpy(_vertex + attributes[VERTEX_POSITION].offset, position, sizeof(position));
+        memcpy(_vertex + attributes[VERTEX_NORMAL].offset, normal, sizeof(normal));
+        memcpy(_vertex + attributes[VERTEX_TEXCOORD].offset, texCoord, sizeof(texCoord));
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// IEEE 754 binary16, rounded to nearest, overflow to infinity, small values to subnormals
+//------------------------------------------------------------------------------------------
+GLushort VertexFormat::floatToHalf(float _value)
+{
+    quint32 bits;
+    memcpy(&bits, &_value, sizeof(bits));
+
+    quint32 sign = (bits >> 16) & 0x8000;
+    qint32 exponent = (qint32)((bits >> 23) & 0xff) - 127 + 15;
+    quint32 mantissa = bits & 0x7fffff;
+
+    // NaN and infinity
+    if(((bits >> 23) & 0xff) == 0xff)
+    {
+        return (GLushort)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+
+    if(exponent >= 31)
+    {
+        return (GLushort)(sign | 0x7c00);
+    }
+
+    if(exponent <= 0)
+    {
+        if(exponent < -10)
+        {
+            return (GLushort)sign;
+        }
+
+        mantissa |= 0x800000;
+        quint32 shift = (quint32)(14 - exponent);
+        quint32 half = mantissa >> shift;
+
+        if((mantissa >> (shift - 1)) & 1)
+        {
+            ++half;
+        }
+
+        return (GLushort)(sign | half);
+    }
+
+    quint32 half = sign | ((quint32)exponent << 10) | (mantissa >> 13);
+
+    // the carry of the rounding may correctly move to the next exponent
+    if(mantissa & 0x1000)
+    {
+        ++half;
+    }
+
+    return (GLushort)half;
+}
+
+//------------------------------------------------------------------------------------------
+// projection on the octahedron |x| + |y| + |z| = 1, the lower half folded over the upper,
+// z is the axis of the octahedron
+//------------------------------------------------------------------------------------------
+QVector2D VertexFormat::encodeOctahedral(const QVector3D& _normal)
+{
+    float l1Norm = fabs(_normal.x()) + fabs(_normal.y()) + fabs(_normal.z());
+
+    if(l1Norm == 0.0f)
+    {
+        return QVector2D(0.0f, 0.0f);
+    }
+
+    QVector2D encoded(_normal.x() / l1Norm, _normal.y() / l1Norm);
+
+    if(_normal.z() < 0.0f)
+    {
+        float signX = encoded.x() >= 0.0f ? 1.0f : -1.0f;
+        float signY = encoded.y() >= 0.0f ? 1.0f : -1.0f;
+
+        encoded = QVector2D((1.0f - fabs(encoded.y())) * signX,
+                            (1.0f - fabs(encoded.x())) * signY);
+    }
+
+    return encoded;
+}
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------------------
+// vertexformat.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <QOpenGLFunctions_4_0_Core>
+#include <QVector2D>
+#include <QVector3D>
+
+enum VertexEncoding
+{
+    FULL_PRECISION_VERTICES = 0,
+    COMPRESSED_VERTICES
+};
+
+enum VertexAttribute
+{
+    VERTEX_POSITION = 0,
+    VERTEX_NORMAL,
+    VERTEX_TEXCOORD,
+    NUM_VERTEX_ATTRIBUTES
+};
+
+struct VertexAttributeFormat
+{
+    GLenum type;
+    GLint tupleSize;
+    GLboolean normalized;
+    int offset;
+};
+
+//------------------------------------------------------------------------------------------
+// Interleaved vertex layout, the single description of the stride, the attribute offsets
+// and the encodings used to write the vertices and to set up the vertex arrays.
+// Full precision: float3 position, float3 normal, float2 texcoord (32 bytes).
+// Compressed: half3 position (padded to 8 bytes), octahedral snorm16x2 normal,
+// unorm16x2 texcoord in [0, 1] (16 bytes). The shader decodes the octahedral normal.
+//------------------------------------------------------------------------------------------
+class VertexFormat
+{
+public:
+    explicit VertexFormat(VertexEncoding _encoding = FULL_PRECISION_VERTICES);
+
+    VertexEncoding getEncoding() const;
+    int getStride() const;
+    bool hasOctahedralNormals() const;
+    const VertexAttributeFormat& getAttribute(VertexAttribute _attribute) const;
+
+    // the vertex buffer must be bound to GL_ARRAY_BUFFER
+    void setupAttribute(QOpenGLFunctions_4_0_Core* _gl, GLuint _location,
+                        VertexAttribute _attribute) const;
+
+    void writeVertex(const QVector3D& _position, const QVector3D& _normal,
+                     const QVector2D& _texCoord, uchar* _vertex) const;
+
+    static GLushort floatToHalf(float _value);
+    static QVector2D encodeOctahedral(const QVector3D& _normal);
+
+private:
+    void setAttribute(VertexAttribute _attribute, GLenum _type, GLint _tupleSize,
+                      GLboolean _normalized, int _offset);
+
+    VertexEncoding encoding;
+    int stride;
+    VertexAttributeFormat attributes[NUM_VERTEX_ATTRIBUTES];
+};
+
+#endif // VERTEXFORMAT_H
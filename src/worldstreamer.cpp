@@ -0,0 +1,529 @@
+//------------------------------------------------------------------------------------------
+// worldstreamer.cpp
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "worldstreamer.h"
+
+//------------------------------------------------------------------------------------------
+WorldStreamer::WorldStreamer():
+    gl(NULL),
+    numPendingLoads(0),
+    residentBytes(0),
+    billboardsChanged(false),
+    busy(false),
+    vertexBuffer(0),
+    chunkVertexBytes(0),
+    numChunkVertices(0),
+    indexBuffer(0),
+    numIndices(0),
+    indexType(GL_UNSIGNED_SHORT)
+{
+}
+
+//------------------------------------------------------------------------------------------
+void WorldStreamer::create(QOpenGLFunctions_4_0_Core* _gl, const WorldParameters& _parameters)
+{
+    if(isCreated())
+    {
+        destroy();
+    }
+
+    gl = _gl;
+    parameters = _parameters;
+    busy = true;
+}
+
+//------------------------------------------------------------------------------------------
+// the loads still running finish on the pool, their results are discarded
+//------------------------------------------------------------------------------------------
+void WorldStreamer::destroy()
+{
+    if(!isCreated())
+    {
+        return;
+    }
+
+    for(Chunk& chunk : chunks)
+    {
+        releaseChunkBuffer(chunk);
+    }
+
+    chunks.clear();
+
+    if(vertexBuffer)
+    {
+        gl->glDeleteBuffers(1, &vertexBuffer);
+        vertexBuffer = 0;
+        freeSlots.clear();
+    }
+
+    if(indexBuffer)
+    {
+        gl->glDeleteBuffers(1, &indexBuffer);
+        indexBuffer = 0;
+    }
+
+    gl = NULL;
+    numPendingLoads = 0;
+    residentBytes = 0;
+    billboardsChanged = false;
+    busy = false;
+}
+
+//------------------------------------------------------------------------------------------
+bool WorldStreamer::isCreated() const
+{
+    return (gl != NULL);
+}
+
+//------------------------------------------------------------------------------------------
+bool WorldStreamer::update(const QVector3D& _cameraPosition)
+{
+    cameraPosition = _cameraPosition;
+    billboardsChanged = false;
+
+    unloadFarChunks();
+    collectLoadedChunks();
+    requestNearChunks();
+    uploadChunks();
+
+    return billboardsChanged;
+}
+
+//------------------------------------------------------------------------------------------
+// loads in flight, uploads in progress or chunks waiting for a load
+//------------------------------------------------------------------------------------------
+bool WorldStreamer::isBusy() const
+{
+    return busy;
+}
+
+//------------------------------------------------------------------------------------------
+void WorldStreamer::unloadFarChunks()
+{
+    QHash<QPoint, Chunk>::iterator it = chunks.begin();
+
+    while(it != chunks.end())
+    {
+        if(getDistance(it.key()) <= WORLD_UNLOAD_RADIUS)
+        {
+            ++it;
+            continue;
+        }
+
+        if(it->state == CHUNK_LOADING)
+        {
+            --numPendingLoads;
+        }
+
+        releaseChunkBuffer(*it);
+        it = chunks.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+void WorldStreamer::collectLoadedChunks()
+{
+    for(Chunk& chunk : chunks)
+    {
+        if(chunk.state == CHUNK_LOADING && chunk.future.isFinished())
+        {
+            chunk.data = chunk.future.result();
+            chunk.future = QFuture<QSharedPointer<WorldChunkData> >();
+            chunk.state = CHUNK_LOADED;
+            --numPendingLoads;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// the missing cells within the load radius are requested nearest first
+//------------------------------------------------------------------------------------------
+void WorldStreamer::requestNearChunks()
+{
+    int cellRadius = (int)ceil(WORLD_LOAD_RADIUS / WORLD_CHUNK_SIZE);
+    QPoint cameraCell((int)floor(cameraPosition.x() / WORLD_CHUNK_SIZE),
+                      (int)floor(cameraPosition.z() / WORLD_CHUNK_SIZE));
+    QVector<QPair<float, QPoint> > missingCells;
+
+    for(int z = cameraCell.y() - cellRadius; z <= cameraCell.y() + cellRadius; ++z)
+    {
+        for(int x = cameraCell.x() - cellRadius; x <= cameraCell.x() + cellRadius; ++x)
+        {
+            QPoint cell(x, z);
+            float distance = getDistance(cell);
+
+            if(distance <= WORLD_LOAD_RADIUS && !chunks.contains(cell))
+            {
+                missingCells.append(qMakePair(distance, cell));
+            }
+        }
+    }
+
+    std::sort(missingCells.begin(), missingCells.end(),
+              [](const QPair<float, QPoint>& _a, const QPair<float, QPoint>& _b)
+    {
+        return _a.first < _b.first;
+    });
+
+    for(const QPair<float, QPoint>& missingCell : missingCells)
+    {
+        if(numPendingLoads >= WORLD_MAX_PENDING_LOADS)
+        {
+            break;
+        }
+
+        Chunk chunk;
+        chunk.state = CHUNK_LOADING;
+        chunk.future = QtConcurrent::run(&WorldStreamer::loadChunk, missingCell.second,
+                                         parameters);
+        chunk.slot = -1;
+        chunk.uploadedBytes = 0;
+
+        chunks.insert(missingCell.second, chunk);
+        ++numPendingLoads;
+    }
+
+    busy = (numPendingLoads > 0) || (missingCells.size() > 0);
+}
+
+//------------------------------------------------------------------------------------------
+// the slot of a chunk is reserved when its upload starts, then filled by slices
+//------------------------------------------------------------------------------------------
+void WorldStreamer::uploadChunks()
+{
+    QVector<QPair<float, QPoint> > pendingCells;
+
+    for(QHash<QPoint, Chunk>::const_iterator it = chunks.constBegin();
+        it != chunks.constEnd(); ++it)
+    {
+        if(it->state == CHUNK_LOADED || it->state == CHUNK_UPLOADING)
+        {
+            pendingCells.append(qMakePair(getDistance(it.key()), it.key()));
+        }
+    }
+
+    std::sort(pendingCells.begin(), pendingCells.end(),
+              [](const QPair<float, QPoint>& _a, const QPair<float, QPoint>& _b)
+    {
+        return _a.first < _b.first;
+    });
+
+    int frameBytes = WORLD_UPLOAD_BYTES_PER_FRAME;
+
+    for(const QPair<float, QPoint>& pendingCell : pendingCells)
+    {
+        if(frameBytes == 0)
+        {
+            break;
+        }
+
+        Chunk& chunk = chunks[pendingCell.second];
+        const QByteArray& vertices = chunk.data->ground.getVertices();
+
+        if(chunk.state == CHUNK_LOADED)
+        {
+            if(!vertexBuffer)
+            {
+                createBuffers(chunk.data->ground);
+            }
+
+            chunk.slot = reserveSlot(pendingCell.first);
+
+            if(chunk.slot < 0)
+            {
+                continue;
+            }
+
+            chunk.uploadedBytes = 0;
+            chunk.state = CHUNK_UPLOADING;
+        }
+
+        int size = qMin(vertices.size() - chunk.uploadedBytes, frameBytes);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        gl->glBufferSubData(GL_ARRAY_BUFFER, chunk.slot * chunkVertexBytes + chunk.uploadedBytes,
+                            size, vertices.constData() + chunk.uploadedBytes);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        chunk.uploadedBytes += size;
+        frameBytes -= size;
+        busy = true;
+
+        if(chunk.uploadedBytes == vertices.size())
+        {
+            chunk.state = CHUNK_RESIDENT;
+            billboardsChanged = true;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// take a free slot, or evict the farthest chunk when all are taken,
+// only chunks farther than the requesting one are evicted
+//------------------------------------------------------------------------------------------
+int WorldStreamer::reserveSlot(float _distance)
+{
+    if(freeSlots.isEmpty())
+    {
+        Chunk* farthestChunk = NULL;
+        float farthestDistance = _distance;
+
+        for(QHash<QPoint, Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it)
+        {
+            float distance = getDistance(it.key());
+
+            if(it->slot >= 0 && distance > farthestDistance)
+            {
+                farthestChunk = &it.value();
+                farthestDistance = distance;
+            }
+        }
+
+        if(!farthestChunk)
+        {
+            return -1;
+        }
+
+        releaseChunkBuffer(*farthestChunk);
+    }
+
+    int slot = freeSlots.takeLast();
+    residentBytes += chunkVertexBytes;
+
+    return slot;
+}
+
+//------------------------------------------------------------------------------------------
+// the chunk keeps its CPU data, it is uploaded again when it fits
+//------------------------------------------------------------------------------------------
+void WorldStreamer::releaseChunkBuffer(Chunk& _chunk)
+{
+    if(_chunk.slot < 0)
+    {
+        return;
+    }
+
+    if(_chunk.state == CHUNK_RESIDENT)
+    {
+        billboardsChanged = true;
+    }
+
+    freeSlots.append(_chunk.slot);
+    residentBytes -= chunkVertexBytes;
+
+    _chunk.slot = -1;
+    _chunk.uploadedBytes = 0;
+    _chunk.state = CHUNK_LOADED;
+}
+
+//------------------------------------------------------------------------------------------
+// every chunk has the same grid, the vertex buffer holds as many chunks as fit in the budget
+//------------------------------------------------------------------------------------------
+void WorldStreamer::createBuffers(const GridMesh& _ground)
+{
+    chunkVertexBytes = _ground.getVertices().size();
+    numChunkVertices = _ground.getNumVertices();
+    int numSlots = qMax(1, WORLD_GPU_BUDGET / chunkVertexBytes);
+
+    gl->glGenBuffers(1, &vertexBuffer);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    gl->glBufferData(GL_ARRAY_BUFFER, numSlots * chunkVertexBytes, NULL, GL_STATIC_DRAW);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    freeSlots.resize(numSlots);
+
+    // the slots are taken from the back, in increasing order
+    for(int slot = 0; slot < numSlots; ++slot)
+    {
+        freeSlots[slot] = numSlots - 1 - slot;
+    }
+
+    /////////////////////////////////////////////////////////////////
+    const QByteArray& indices = _ground.getIndices();
+
+    gl->glGenBuffers(1, &indexBuffer);
+    gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    gl->glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size(), indices.constData(),
+                     GL_STATIC_DRAW);
+    gl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    numIndices = _ground.getNumIndices();
+    indexType = _ground.getIndexType();
+}
+
+//------------------------------------------------------------------------------------------
+void WorldStreamer::getBillboardInstances(QVector<BillboardInstance>& _instances) const
+{
+    _instances.resize(0);
+
+    for(const Chunk& chunk : chunks)
+    {
+        if(chunk.state == CHUNK_RESIDENT)
+        {
+            _instances += chunk.data->billboards;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+QVector<WorldChunkBuffer> WorldStreamer::getResidentChunks() const
+{
+    QVector<WorldChunkBuffer> residentChunks;
+
+    for(QHash<QPoint, Chunk>::const_iterator it = chunks.constBegin();
+        it != chunks.constEnd(); ++it)
+    {
+        if(it->state != CHUNK_RESIDENT)
+        {
+            continue;
+        }
+
+        WorldChunkBuffer chunkBuffer;
+        chunkBuffer.center = getCellCenter(it.key());
+        chunkBuffer.boundMin = chunkBuffer.center +
+                               QVector3D(-0.5f * WORLD_CHUNK_SIZE, it->data->minHeight,
+                                         -0.5f * WORLD_CHUNK_SIZE);
+        chunkBuffer.boundMax = chunkBuffer.center +
+                               QVector3D(0.5f * WORLD_CHUNK_SIZE, it->data->maxHeight,
+                                         0.5f * WORLD_CHUNK_SIZE);
+        chunkBuffer.baseVertex = it->slot * numChunkVertices;
+        residentChunks.append(chunkBuffer);
+    }
+
+    return residentChunks;
+}
+
+//------------------------------------------------------------------------------------------
+GLuint WorldStreamer::getVertexBuffer() const
+{
+    return vertexBuffer;
+}
+
+//------------------------------------------------------------------------------------------
+GLuint WorldStreamer::getIndexBuffer() const
+{
+    return indexBuffer;
+}
+
+//------------------------------------------------------------------------------------------
+int WorldStreamer::getNumIndices() const
+{
+    return numIndices;
+}
+
+//------------------------------------------------------------------------------------------
+GLenum WorldStreamer::getIndexType() const
+{
+    return indexType;
+}
+
+//------------------------------------------------------------------------------------------
+int WorldStreamer::getResidentBytes() const
+{
+    return residentBytes;
+}
+
+//------------------------------------------------------------------------------------------
+// smooth procedural terrain, continuous across the chunk borders
+//------------------------------------------------------------------------------------------
+float WorldStreamer::getTerrainHeight(float _x, float _z)
+{
+    return WORLD_TERRAIN_HEIGHT * (0.5f + 0.3f * sin(0.031f * _x) * cos(0.027f * _z) +
+                                   0.2f * sin(0.071f * _x + 0.053f * _z));
+}
+
+//------------------------------------------------------------------------------------------
+QVector3D WorldStreamer::getCellCenter(const QPoint& _cell)
+{
+    return QVector3D(((float)_cell.x() + 0.5f) * WORLD_CHUNK_SIZE, 0.0f,
+                     ((float)_cell.y() + 0.5f) * WORLD_CHUNK_SIZE);
+}
+
+//------------------------------------------------------------------------------------------
+float WorldStreamer::getDistance(const QPoint& _cell) const
+{
+    QVector3D center = getCellCenter(_cell);
+    return QVector2D(center.x() - cameraPosition.x(),
+                     center.z() - cameraPosition.z()).length();
+}
+
+//------------------------------------------------------------------------------------------
+// Runs on the thread pool. The ground grid spans the chunk through a model matrix scaling
+// [-1, 1] to the chunk size, its heights are divided by the same scale.
+// The heights are sampled with a one-sample apron around the chunk, so the normals along
+// its border match the ones of the neighbouring chunks.
+// The billboards of a cell are always the same, the generator is seeded by the cell.
+//------------------------------------------------------------------------------------------
+QSharedPointer<WorldChunkData> WorldStreamer::loadChunk(QPoint _cell,
+                                                         WorldParameters _parameters)
+{
+    QSharedPointer<WorldChunkData> data(new WorldChunkData);
+    data->cell = _cell;
+
+    /////////////////////////////////////////////////////////////////
+    // ground
+    int numSamples = WORLD_CHUNK_SUBDIVISIONS + 3;
+    float halfSize = 0.5f * WORLD_CHUNK_SIZE;
+    float originX = (float)_cell.x() * WORLD_CHUNK_SIZE;
+    float originZ = (float)_cell.y() * WORLD_CHUNK_SIZE;
+    QVector<float> heights(numSamples * numSamples);
+
+    data->minHeight = WORLD_TERRAIN_HEIGHT;
+    data->maxHeight = 0.0f;
+
+    for(int j = 0; j < numSamples; ++j)
+    {
+        for(int i = 0; i < numSamples; ++i)
+        {
+            float height = getTerrainHeight(originX + (float)(i - 1) * WORLD_CHUNK_SIZE /
+                                            (float)WORLD_CHUNK_SUBDIVISIONS,
+                                            originZ + (float)(j - 1) * WORLD_CHUNK_SIZE /
+                                            (float)WORLD_CHUNK_SUBDIVISIONS);
+            heights[j * numSamples + i] = height / halfSize;
+
+            // the apron is outside of the chunk bounds
+            if(i > 0 && j > 0 && i < numSamples - 1 && j < numSamples - 1)
+            {
+                data->minHeight = qMin(data->minHeight, height);
+                data->maxHeight = qMax(data->maxHeight, height);
+            }
+        }
+    }
+
+    data->ground.setHeightmap(heights, numSamples, numSamples, 1);
+    data->ground.generate(WORLD_CHUNK_SUBDIVISIONS, WORLD_CHUNK_SUBDIVISIONS,
+                          _parameters.vertexFormat);
+
+    /////////////////////////////////////////////////////////////////
+    // billboards
+    std::mt19937 generator((quint32)_cell.x() * 73856093u ^ (quint32)_cell.y() * 19349663u);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    data->billboards.resize(WORLD_BILLBOARDS_PER_CHUNK);
+
+    for(BillboardInstance& instance : data->billboards)
+    {
+        float x = originX + uniform(generator) * WORLD_CHUNK_SIZE;
+        float z = originZ + uniform(generator) * WORLD_CHUNK_SIZE;
+
+        instance.scale = _parameters.billboardScale * (0.5f + 0.5f * uniform(generator));
+        instance.position = QVector3D(x, getTerrainHeight(x, z) +
+                                      instance.scale * _parameters.billboardBaseHeight, z);
+
+        float shade = 0.8f + 0.2f * uniform(generator);
+        instance.tint = QVector4D(shade, shade, shade, 1.0f);
+        instance.textureLayer = (float)(generator() % (quint32)qMax(1,
+                                                                    _parameters.numTextureLayers));
+    }
+
+    return data;
+}
@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------------------
+// worldstreamer.h
+//
+// Created on: 10/16/2026
+//     Author: Nghia Truong
+//
+//------------------------------------------------------------------------------------------
+
+#ifndef WORLDSTREAMER_H
+#define WORLDSTREAMER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QOpenGLFunctions_4_0_Core>
+#include <QPoint>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "billboardinstance.h"
+#include "gridmesh.h"
+
+#define WORLD_CHUNK_SIZE 32.0f
+#define WORLD_CHUNK_SUBDIVISIONS 32
+#define WORLD_BILLBOARDS_PER_CHUNK 256
+#define WORLD_TERRAIN_HEIGHT 3.0f
+// the unload radius is larger, a chunk at the border is not reloaded back and forth
+#define WORLD_LOAD_RADIUS 192.0f
+#define WORLD_UNLOAD_RADIUS 224.0f
+#define WORLD_MAX_PENDING_LOADS 4
+#define WORLD_GPU_BUDGET (16 * 1024 * 1024)
+#define WORLD_UPLOAD_BYTES_PER_FRAME (128 * 1024)
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+inline uint qHash(const QPoint& _point, uint _seed = 0)
+{
+    return qHash(qMakePair(_point.x(), _point.y()), _seed);
+}
+#endif
+
+//------------------------------------------------------------------------------------------
+// what the background loader needs to build a chunk
+//------------------------------------------------------------------------------------------
+struct WorldParameters
+{
+    VertexFormat vertexFormat;
+    int numTextureLayers;
+    float billboardScale;
+    // height of the billboard center above the ground, relative to its scale
+    float billboardBaseHeight;
+};
+
+//------------------------------------------------------------------------------------------
+// CPU data of a chunk, built on the thread pool
+//------------------------------------------------------------------------------------------
+struct WorldChunkData
+{
+    QPoint cell;
+    GridMesh ground;
+    float minHeight;
+    float maxHeight;
+    QVector<BillboardInstance> billboards;
+};
+
+//------------------------------------------------------------------------------------------
+// a ground chunk whose vertices are fully uploaded, at baseVertex in the shared buffer
+//------------------------------------------------------------------------------------------
+struct WorldChunkBuffer
+{
+    QVector3D center;
+    QVector3D boundMin;
+    QVector3D boundMax;
+    GLint baseVertex;
+};
+
+//------------------------------------------------------------------------------------------
+// Tiled world streamed around the camera: ground chunks and their billboards keyed by
+// grid cell in the xz plane. The chunks within WORLD_LOAD_RADIUS are built on the thread
+// pool, those beyond WORLD_UNLOAD_RADIUS are dropped. The ground vertices are uploaded
+// nearest first, at most WORLD_UPLOAD_BYTES_PER_FRAME per frame, into the slots of one
+// vertex buffer of WORLD_GPU_BUDGET bytes; the farthest chunks are evicted when all slots
+// are taken. A chunk shows its billboards once its ground is resident.
+// All chunks share the vertex and the index buffer, they are drawn with their base vertex.
+// The GL calls need the context current.
+//------------------------------------------------------------------------------------------
+class WorldStreamer
+{
+public:
+    WorldStreamer();
+
+    void create(QOpenGLFunctions_4_0_Core* _gl, const WorldParameters& _parameters);
+    void destroy();
+    bool isCreated() const;
+
+    // returns true when the set of resident billboards changed
+    bool update(const QVector3D& _cameraPosition);
+    bool isBusy() const;
+
+    void getBillboardInstances(QVector<BillboardInstance>& _instances) const;
+    QVector<WorldChunkBuffer> getResidentChunks() const;
+
+    GLuint getVertexBuffer() const;
+    GLuint getIndexBuffer() const;
+    int getNumIndices() const;
+    GLenum getIndexType() const;
+    int getResidentBytes() const;
+
+    static float getTerrainHeight(float _x, float _z);
+
+private:
+    enum ChunkState
+    {
+        CHUNK_LOADING = 0,
+        CHUNK_LOADED,
+        CHUNK_UPLOADING,
+        CHUNK_RESIDENT
+    };
+
+    struct Chunk
+    {
+        ChunkState state;
+        QFuture<QSharedPointer<WorldChunkData> > future;
+        QSharedPointer<WorldChunkData> data;
+        // slot of the chunk in the vertex buffer, -1 while it has none
+        int slot;
+        int uploadedBytes;
+    };
+
+    static QSharedPointer<WorldChunkData> loadChunk(QPoint _cell,
+                                                    WorldParameters _parameters);
+
+    static QVector3D getCellCenter(const QPoint& _cell);
+    float getDistance(const QPoint& _cell) const;
+
+    void unloadFarChunks();
+    void collectLoadedChunks();
+    void requestNearChunks();
+    void uploadChunks();
+    int reserveSlot(float _distance);
+    void releaseChunkBuffer(Chunk& _chunk);
+    void createBuffers(const GridMesh& _ground);
+
+    QOpenGLFunctions_4_0_Core* gl;
+    WorldParameters parameters;
+    QVector3D cameraPosition;
+
+    QHash<QPoint, Chunk> chunks;
+    int numPendingLoads;
+    int residentBytes;
+    bool billboardsChanged;
+    bool busy;
+
+    GLuint vertexBuffer;
+    int chunkVertexBytes;
+    int numChunkVertices;
+    QVector<int> freeSlots;
+
+    GLuint indexBuffer;
+    int numIndices;
+    GLenum indexType;
+};
+
+#endif // WORLDSTREAMER_H